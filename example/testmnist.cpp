@@ -49,6 +49,10 @@ using namespace std;
 /*!
  * The function that runs the network over
  * the entire MNIST test dataset.
+ * Images (28x28) are fed as they are when the source plane of the network
+ * pads them, e.g. a 32x32 source plane declaring padding="2":
+ * <plane id="s" type="source" featuremapsize="32x32" padding="2">
+ * Networks taking 32x32 images get them padded here.
  * \return Exit code
  */
 int main(int argc, char *argv[])
@@ -98,16 +102,20 @@ int main(int argc, char *argv[])
 		int imgno = 10000; // 10'000 images in file
 		int imgheight = 28; // image size
 		int imgwidth = 28;
-		int imgpadx = 2; // Pad images by 2 black pixels, so
-		int imgpady = 2; // the image becomes 32x32
-		int imgpaddedheight = imgheight+2*imgpady; // padded image size
-		int imgpaddedwidth = imgwidth+2*imgpadx;
 		
-		// Prepare image structures
-		IplImage *img32 = cvCreateImageHeader( cvSize(imgpaddedheight,imgpaddedwidth), IPL_DEPTH_8U, 1 );
-	
-		// imageData now points to our buffer
-		img32->imageData = buffer;
+		// Pad images by 2 black pixels unless the network does it
+		CvSize inputsz = net.getinputsz();
+		int imgpad = (inputsz.width == imgwidth+4 && inputsz.height == imgheight+4) ? 2 : 0;
+		if ( inputsz.width != imgwidth+2*imgpad || inputsz.height != imgheight+2*imgpad )
+		{
+			cerr << "ERROR: The network takes neither 28x28 nor 32x32 images" << endl;
+			delete[] label;
+			delete[] buffer;
+			return 1;
+		}
+		
+		// Image header pointing to our buffer
+		CvMat img = cvMat( inputsz.height, inputsz.width, CV_8UC1, buffer );
 	
 		// Clean the buffer
 		memset(buffer,0,BUF_SIZE);
@@ -118,17 +126,15 @@ int main(int argc, char *argv[])
 		// Now cycle over all images in MNIST test dataset
 		for (int i=0; i<imgno; i++)
 		{
-			// Load the image from file stream into img32
-			// (remember img32->imgData points to our buffer)
+			// Load the image from file stream into our buffer row-by-row,
+			// leaving the padding black
 			for (int k=0; k<imgheight; k++)
 			{
-				// Image in file is stored as 28x28, so we need to pad it to 32x32
-				// So we read the image row-by-row with proper padding adjustments
-				f1.read(&buffer[imgpadx+(imgpaddedwidth)*(k+2)],imgwidth);
+				f1.read(&buffer[imgpad+inputsz.width*(k+imgpad)],imgwidth);
 			}
 	
 			// Propagate the matrix through network and get the result
-			int pos = (int) net.fprop(img32);
+			int pos = (int) net.fprop(&img);
 			
 			// Now read the correct label from label file stream
 			f2.read(label,1);
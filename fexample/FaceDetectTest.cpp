@@ -0,0 +1,128 @@
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "FaceDetectTest.h"
+#include "cnn.h"
+
+// findFaces has no detector argument, so the last loaded detector is
+// used by all calls. Calls must not overlap.
+static Cnn* faceDetector = NULL;
+
+// The luma plane of an NV21 frame is its first width*height bytes, so
+// it is wrapped as a grey image without any copy or colour conversion.
+static std::vector<cv::Rect> detectLuma(int width, int height, unsigned char* yuv)
+{
+    cv::Mat luma(height, width, CV_8UC1, yuv);
+    cv::Mat equalized;
+    std::vector<cv::Rect> faces;
+
+    cv::equalizeHist(luma, equalized);
+    faces = faceDetector->detectFaces(equalized);
+    return faces;
+} // detectLuma
+
+JNIEXPORT jlong JNICALL Java_FaceDetectTest_loadFaceDetector
+  (JNIEnv* env, jclass, jstring cascadeFile, jstring cnnFile)
+{
+    const char* cascadePath = env->GetStringUTFChars(cascadeFile, NULL);
+    const char* cnnPath = env->GetStringUTFChars(cnnFile, NULL);
+
+    Cnn* cnn = new Cnn();
+    bool loaded = cnn->loadCascade(const_cast<char*>(cascadePath))
+                  && cnn->loadConvNet(const_cast<char*>(cnnPath));
+
+    env->ReleaseStringUTFChars(cascadeFile, cascadePath);
+    env->ReleaseStringUTFChars(cnnFile, cnnPath);
+
+    if (!loaded)
+    {
+        delete cnn;
+        return 0;
+    } // if
+
+    delete faceDetector;
+    faceDetector = cnn;
+    return (jlong) cnn;
+} // Java_FaceDetectTest_loadFaceDetector
+
+// Frames of no pixels or of more pixels than a Java array holds are
+// rejected before any cv::Mat is made of them
+static bool isFrameSize(jint width, jint height)
+{
+    return width > 0 && height > 0 && (jlong) width * height <= 0x7fffffff;
+} // isFrameSize
+
+// Detects faces in an NV21 frame and draws them into the ARGB preview
+// the caller shows. Both arrays are pinned instead of copied, each one
+// only while it is used: yuv for detection, rgba for drawing.
+JNIEXPORT jlong JNICALL Java_FaceDetectTest_findFaces
+  (JNIEnv* env, jclass, jint width, jint height, jbyteArray yuv, jintArray rgba)
+{
+    if (faceDetector == NULL || !isFrameSize(width, height)
+        || env->GetArrayLength(yuv) < width * height
+        || env->GetArrayLength(rgba) < width * height)
+    {
+        return -1;
+    } // if
+
+    // No JNI calls are allowed until the array is released
+    unsigned char* yuvData = (unsigned char*) env->GetPrimitiveArrayCritical(yuv, NULL);
+    if (yuvData == NULL)
+    {
+        return -1;
+    } // if
+    std::vector<cv::Rect> faces = detectLuma(width, height, yuvData);
+    env->ReleasePrimitiveArrayCritical(yuv, yuvData, JNI_ABORT);
+
+    jint* rgbaData = (jint*) env->GetPrimitiveArrayCritical(rgba, NULL);
+    if (rgbaData == NULL)
+    {
+        return -1;
+    } // if
+
+    // ARGB ints are B,G,R,A bytes on little-endian machines
+    cv::Mat preview(height, width, CV_8UC4, rgbaData);
+    for (int faceIndex = 0; faceIndex < faces.size(); faceIndex++)
+    {
+        cv::rectangle(preview, faces[faceIndex], cv::Scalar(0, 255, 0, 255), 1, 8, 0);
+    } // for
+    env->ReleasePrimitiveArrayCritical(rgba, rgbaData, 0);
+
+    return faces.size();
+} // Java_FaceDetectTest_findFaces
+
+// Detects and scores faces in an NV21 frame held by a direct buffer.
+// Every face takes five ints of the faces buffer: x, y, width, height
+// and the network score in thousandths. The luma plane goes straight into
+// the network without an intermediate colour image.
+JNIEXPORT jlong JNICALL Java_FaceDetectTest_findFacesDirect
+  (JNIEnv* env, jclass, jint width, jint height, jobject yuv, jobject faces)
+{
+    unsigned char* yuvData = (unsigned char*) env->GetDirectBufferAddress(yuv);
+    jint* faceData = (jint*) env->GetDirectBufferAddress(faces);
+
+    if (faceDetector == NULL || yuvData == NULL || faceData == NULL
+        || !isFrameSize(width, height)
+        || env->GetDirectBufferCapacity(yuv) < (jlong) width * height)
+    {
+        return -1;
+    } // if
+
+    std::vector<cv::Rect> rects = detectLuma(width, height, yuvData);
+    std::vector<double> scores = faceDetector->scoreFaces(cv::Mat(height, width, CV_8UC1, yuvData), rects);
+
+    // Faces that don't fit are counted but not written
+    jlong capacity = env->GetDirectBufferCapacity(faces) / 5;
+    for (int faceIndex = 0; faceIndex < rects.size() && faceIndex < capacity; faceIndex++)
+    {
+        jint* face = faceData + 5 * faceIndex;
+        face[0] = rects[faceIndex].x;
+        face[1] = rects[faceIndex].y;
+        face[2] = rects[faceIndex].width;
+        face[3] = rects[faceIndex].height;
+        face[4] = (jint) (scores[faceIndex] * 1000.0);
+    } // for
+    return rects.size();
+} // Java_FaceDetectTest_findFacesDirect
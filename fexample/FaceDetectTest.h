@@ -23,6 +23,14 @@ JNIEXPORT jlong JNICALL Java_FaceDetectTest_loadFaceDetector
 JNIEXPORT jlong JNICALL Java_FaceDetectTest_findFaces
   (JNIEnv *, jclass, jint, jint, jbyteArray, jintArray);
 
+/*
+ * Class:     FaceDetectTest
+ * Method:    findFacesDirect
+ * Signature: (IILjava/nio/ByteBuffer;Ljava/nio/IntBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_FaceDetectTest_findFacesDirect
+  (JNIEnv *, jclass, jint, jint, jobject, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,10 +1,91 @@
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+
 class FaceDetectTest
 {
     static native long loadFaceDetector(String cascadeFile, String cnnFile);
     static native long findFaces(int width, int height, byte[] yuv, int[] rgba);
+    static native long findFacesDirect(int width, int height, ByteBuffer yuv, IntBuffer faces);
 
     static
     {
         System.loadLibrary("FaceDetectTest");
     } // static
+
+    static byte[] readFrame(String fileName) throws IOException
+    {
+        File file = new File(fileName);
+        byte[] frame = new byte[(int) file.length()];
+        FileInputStream stream = new FileInputStream(file);
+        try
+        {
+            int offset = 0;
+            while (offset < frame.length)
+            {
+                int count = stream.read(frame, offset, frame.length - offset);
+                if (count < 0)
+                {
+                    break;
+                } // if
+                offset += count;
+            } // while
+        } // try
+        finally
+        {
+            stream.close();
+        } // finally
+        return frame;
+    } // readFrame
+
+    // Runs the detector over NV21 frames recorded from a camera, so the
+    // native code can be tested on a desktop JVM
+    public static void main(String[] args) throws IOException
+    {
+        if (args.length < 5)
+        {
+            System.err.println("Usage: ");
+            System.err.println("\tjava FaceDetectTest <cascade.xml> <network.xml> <width> <height> <frame.nv21> ...");
+            System.exit(1);
+        } // if
+
+        if (loadFaceDetector(args[0], args[1]) == 0)
+        {
+            System.err.println("Unable to load face detector");
+            System.exit(1);
+        } // if
+
+        int width = Integer.parseInt(args[2]);
+        int height = Integer.parseInt(args[3]);
+        int[] rgba = new int[width * height];
+        ByteBuffer yuv = ByteBuffer.allocateDirect(width * height * 3 / 2);
+        IntBuffer faces = ByteBuffer.allocateDirect(5 * 4 * 64).order(ByteOrder.nativeOrder()).asIntBuffer();
+
+        for (int fileIndex = 4; fileIndex < args.length; fileIndex++)
+        {
+            byte[] frame = readFrame(args[fileIndex]);
+            if (frame.length < width * height * 3 / 2)
+            {
+                System.err.println(args[fileIndex] + ": not a " + width + "x" + height + " NV21 frame");
+                continue;
+            } // if
+
+            long count = findFaces(width, height, frame, rgba);
+
+            yuv.clear();
+            yuv.put(frame, 0, width * height * 3 / 2);
+            long directCount = findFacesDirect(width, height, yuv, faces);
+
+            System.out.println(args[fileIndex] + ": " + count + " faces");
+            for (int faceIndex = 0; faceIndex < Math.min(directCount, faces.capacity() / 5); faceIndex++)
+            {
+                System.out.println("\t" + faces.get(5 * faceIndex) + "," + faces.get(5 * faceIndex + 1)
+                                   + " " + faces.get(5 * faceIndex + 2) + "x" + faces.get(5 * faceIndex + 3)
+                                   + " score " + faces.get(5 * faceIndex + 4) / 1000.0);
+            } // for
+        } // for
+    } // main
 }
@@ -0,0 +1,78 @@
+#ifndef _BOUNDEDQUEUE_H_INCLUDED
+#define _BOUNDEDQUEUE_H_INCLUDED
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Queue between two pipeline stages. push() blocks while the queue is
+// full, so a slow stage holds back the stages feeding it instead of
+// letting frames pile up. Once closed, push() fails and pop() fails as
+// soon as the queue is empty.
+template <typename T>
+class BoundedQueue
+{
+    std::deque<T> mItems;
+    size_t mCapacity;
+    bool mClosed;
+    std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+
+    public:
+        BoundedQueue(size_t capacity)
+            : mCapacity(capacity), mClosed(false)
+        {
+        } // BoundedQueue
+
+        bool push(T const& item)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mItems.size() >= mCapacity && !mClosed)
+            {
+                mNotFull.wait(lock);
+            } // while
+            if (mClosed)
+            {
+                return false;
+            } // if
+            mItems.push_back(item);
+            mNotEmpty.notify_one();
+            return true;
+        } // BoundedQueue::push
+
+        bool pop(T& item)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mItems.empty() && !mClosed)
+            {
+                mNotEmpty.wait(lock);
+            } // while
+            if (mItems.empty())
+            {
+                return false;
+            } // if
+            item = mItems.front();
+            mItems.pop_front();
+            mNotFull.notify_one();
+            return true;
+        } // BoundedQueue::pop
+
+        // Items already queued can still be popped after close()
+        void close()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mClosed = true;
+            mNotEmpty.notify_all();
+            mNotFull.notify_all();
+        } // BoundedQueue::close
+
+        // Drops items that were not popped yet
+        void clear()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mItems.clear();
+            mNotFull.notify_all();
+        } // BoundedQueue::clear
+};
+#endif // _BOUNDEDQUEUE_H_INCLUDED
@@ -25,13 +25,23 @@ bool Cnn::loadConvNet(char* const filePath)
 
 std::vector<cv::Rect> Cnn::findFaces(cv::Mat const inputImage)
 {
-    std::vector<cv::Rect> faces;
+    return detectFaces(preprocess(inputImage));
+} // Cnn::findFaces
+
+cv::Mat Cnn::preprocess(cv::Mat const inputImage)
+{
     cv::Mat greyInputImage;
     cv::cvtColor(inputImage, greyInputImage, CV_BGR2GRAY);
     cv::equalizeHist(greyInputImage, greyInputImage);
+    return greyInputImage;
+} // Cnn::preprocess
+
+std::vector<cv::Rect> Cnn::detectFaces(cv::Mat const greyInputImage)
+{
+    std::vector<cv::Rect> faces;
     mFaceCascade.detectMultiScale(greyInputImage, faces, 1.1, 2, 2, cv::Size(10, 10));
     return faces;
-} // Cnn::findFaces
+} // Cnn::detectFaces
 
 void Cnn::drawRectangles(std::vector<cv::Rect> rectangles, cv::Mat frame)
 {
@@ -65,3 +75,24 @@ double Cnn::runConvNet(cv::Mat const frame)
     return mConvNet.fprop(&image);
 } // Cnn::runConvNet
 
+// The network samples the proposal straight from the frame, converting
+// it to grey on the fly, so there is no crop, no resized copy and no
+// grey copy of the frame
+double Cnn::runConvNet(cv::Mat const frame, cv::Rect roi)
+{
+    IplImage image = frame;
+    return mConvNet.fprop(&image, cvRect(roi.x, roi.y, roi.width, roi.height), CV_INTER_LINEAR);
+} // Cnn::runConvNet
+
+// Scores all proposals of a frame, colour or grey such as the luma plane
+// of a camera frame. Every proposal is sampled straight from the frame
+// into the source plane, so there is no batch of crops to fill.
+std::vector<double> Cnn::scoreFaces(cv::Mat const inputFrame, std::vector<cv::Rect> const& rois)
+{
+    std::vector<double> scores;
+    for (int roiIndex = 0; roiIndex < rois.size(); roiIndex++)
+    {
+        scores.push_back(runConvNet(inputFrame, rois[roiIndex]));
+    } // for
+    return scores;
+} // Cnn::scoreFaces
@@ -22,8 +22,12 @@ class Cnn
         bool loadCascade(char* const);
         bool loadConvNet(char* const);
         std::vector<cv::Rect> findFaces(cv::Mat const);
+        cv::Mat preprocess(cv::Mat const);
+        std::vector<cv::Rect> detectFaces(cv::Mat const);
         void drawRectangles(std::vector<cv::Rect>, cv::Mat);
         cv::Mat cropFrame(cv::Mat, cv::Rect);
         double runConvNet(cv::Mat const);
+        double runConvNet(cv::Mat const, cv::Rect);
+        std::vector<double> scoreFaces(cv::Mat const, std::vector<cv::Rect> const&);
 };
 #endif // _CNN_H_INCLUDED
@@ -3,6 +3,7 @@
 #include "opencv2/highgui/highgui.hpp"
 
 #include "cnn.h"
+#include "facepipeline.h"
 
 
 int main(int argc, char* argv[])
@@ -31,27 +32,17 @@ int main(int argc, char* argv[])
     } // if
 
     CvCapture* capture;
-    cv::Mat frame;
-    vector<cv::Rect> faces;
     capture = cvCaptureFromCAM(-1);
     if (capture)
     {
-        while(true)
-        {
-            frame = cvQueryFrame(capture);
+        FacePipeline pipeline(cnn, capture);
+        FaceFrame result;
 
-            if (!frame.empty())
-            {
-                faces = cnn.findFaces(frame);
-                cnn.drawRectangles(faces, frame);
-                imshow("Face Detect", frame);
-                
-            } // if
-            else
-            {
-                cerr << "Empty frame!" << endl;
-                break;
-            } // else
+        pipeline.start();
+        while (pipeline.next(result))
+        {
+            cnn.drawRectangles(result.faces, result.frame);
+            imshow("Face Detect", result.frame);
 
             int c = cv::waitKey(10);
             if (((char) c == 'c'))
@@ -60,14 +51,14 @@ int main(int argc, char* argv[])
             } // if
             else if (((char) c == 'f'))
             {
-                for (int faceIndex = 0; faceIndex < faces.size(); faceIndex++)
+                for (int faceIndex = 0; faceIndex < result.scores.size(); faceIndex++)
                 {
-                    cv::Mat roi = cnn.cropFrame(frame, faces[faceIndex]);
-                    double score = cnn.runConvNet(roi);
-                    cerr << "Score: " << score << endl;
+                    cerr << "Score: " << result.scores[faceIndex] << endl;
                 } // for
             } // else if
         } // while
+        pipeline.stop();
+        cvReleaseCapture(&capture);
     } //if
 
 } // main
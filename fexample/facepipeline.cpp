@@ -0,0 +1,125 @@
+#include <iostream>
+
+#include "facepipeline.h"
+
+FacePipeline::FacePipeline(Cnn& cnn, CvCapture* capture, size_t depth)
+    : mCnn(cnn),
+      mCapture(capture),
+      mStop(false),
+      mCaptured(depth),
+      mPreprocessed(depth),
+      mDetected(depth),
+      mScored(depth)
+{
+} // FacePipeline
+
+FacePipeline::~FacePipeline()
+{
+    stop();
+} // ~FacePipeline
+
+void FacePipeline::start()
+{
+    mThreads.push_back(std::thread(&FacePipeline::captureStage, this));
+    mThreads.push_back(std::thread(&FacePipeline::preprocessStage, this));
+    mThreads.push_back(std::thread(&FacePipeline::detectStage, this));
+    mThreads.push_back(std::thread(&FacePipeline::scoreStage, this));
+} // FacePipeline::start
+
+// Returns false when the capture ran out of frames or the pipeline was
+// stopped
+bool FacePipeline::next(FaceFrame& result)
+{
+    return mScored.pop(result);
+} // FacePipeline::next
+
+void FacePipeline::stop()
+{
+    mStop = true;
+
+    // Wake up every stage waiting on a queue, frames in flight are dropped
+    mCaptured.close();
+    mPreprocessed.close();
+    mDetected.close();
+    mScored.close();
+    mCaptured.clear();
+    mPreprocessed.clear();
+    mDetected.clear();
+    mScored.clear();
+
+    for (int threadIndex = 0; threadIndex < mThreads.size(); threadIndex++)
+    {
+        mThreads[threadIndex].join();
+    } // for
+    mThreads.clear();
+} // FacePipeline::stop
+
+void FacePipeline::captureStage()
+{
+    FaceFrame item;
+    long index = 0;
+
+    while (!mStop)
+    {
+        IplImage* image = cvQueryFrame(mCapture);
+        if (image == NULL)
+        {
+            std::cerr << "Empty frame!" << std::endl;
+            break;
+        } // if
+
+        // The capture reuses its buffer for the next frame
+        item.index = index++;
+        item.frame = cv::Mat(image, true);
+        if (!mCaptured.push(item))
+        {
+            break;
+        } // if
+    } // while
+    mCaptured.close();
+} // FacePipeline::captureStage
+
+void FacePipeline::preprocessStage()
+{
+    FaceFrame item;
+    while (mCaptured.pop(item))
+    {
+        item.greyImage = mCnn.preprocess(item.frame);
+        if (!mPreprocessed.push(item))
+        {
+            break;
+        } // if
+    } // while
+    mPreprocessed.close();
+} // FacePipeline::preprocessStage
+
+void FacePipeline::detectStage()
+{
+    FaceFrame item;
+    while (mPreprocessed.pop(item))
+    {
+        item.faces = mCnn.detectFaces(item.greyImage);
+        if (!mDetected.push(item))
+        {
+            break;
+        } // if
+    } // while
+    mDetected.close();
+} // FacePipeline::detectStage
+
+// The network samples every proposal straight from the colour frame and
+// converts it to grey on the fly. The equalized grey image is only for
+// the cascade, the network scores the same pixels as the JNI bridge does.
+void FacePipeline::scoreStage()
+{
+    FaceFrame item;
+    while (mDetected.pop(item))
+    {
+        item.scores = mCnn.scoreFaces(item.frame, item.faces);
+        if (!mScored.push(item))
+        {
+            break;
+        } // if
+    } // while
+    mScored.close();
+} // FacePipeline::scoreStage
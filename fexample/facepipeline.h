@@ -0,0 +1,53 @@
+#ifndef _FACEPIPELINE_H_INCLUDED
+#define _FACEPIPELINE_H_INCLUDED
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "boundedqueue.h"
+#include "cnn.h"
+
+// Everything known about one captured frame. Stages fill it in as the
+// frame travels through the pipeline.
+struct FaceFrame
+{
+    long index;
+    cv::Mat frame;                  // BGR frame as captured
+    cv::Mat greyImage;              // grey and equalized frame, for the cascade
+    std::vector<cv::Rect> faces;    // cascade proposals
+    std::vector<double> scores;     // network output for every proposal
+};
+
+// Runs capture, grey/equalize, cascade and network scoring stages
+// each on its own thread with bounded queues in between, so throughput
+// is limited by the slowest stage rather than by the sum of all of them.
+// The output stage is next(), it is called on the caller's thread because
+// highgui windows have to be updated from the main thread.
+class FacePipeline
+{
+    Cnn& mCnn;
+    CvCapture* mCapture;
+    std::atomic<bool> mStop;
+    BoundedQueue<FaceFrame> mCaptured;
+    BoundedQueue<FaceFrame> mPreprocessed;
+    BoundedQueue<FaceFrame> mDetected;
+    BoundedQueue<FaceFrame> mScored;
+    std::vector<std::thread> mThreads;
+
+    void captureStage();
+    void preprocessStage();
+    void detectStage();
+    void scoreStage();
+
+    public:
+        FacePipeline(Cnn&, CvCapture*, size_t depth = 2);
+        virtual ~FacePipeline();
+        void start();
+        bool next(FaceFrame&);
+        void stop();
+};
+#endif // _FACEPIPELINE_H_INCLUDED
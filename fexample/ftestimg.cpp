@@ -56,7 +56,11 @@ using namespace std;
  * Usage of the program is the following:
  * $ ./testimg [net.xml] [file1] [file2] [file3] ...
  * 
- * net.xml is XML description of the network
+ * net.xml is XML description of the network. Pixels are normalised
+ * by its source plane when it declares them, e.g.
+ * <plane id="s" type="source" featuremapsize="128x128"
+ *        mean="108.08409242" scale="0.00392156862745098">
+ * and by the program otherwise.
  * files must be 128x128
  * no error checking is done!
  */
@@ -92,6 +96,12 @@ int main(int argc, char *argv[])
     CvFont font;
     cvInitFont(&font, CV_FONT_HERSHEY_PLAIN, 1.0, 1.0);
 
+    // Networks declaring no normalisation get it done here
+    double mean, scale;
+    net.getnormalization(mean, scale);
+    bool normalise = (mean == 0.0 && scale == 1.0);
+    CvMat *normalised = cvCreateMat(inputsz.height, inputsz.width, CV_32FC1);
+
     // Grayscale img pointer
     IplImage* img;
 
@@ -108,60 +118,20 @@ int main(int argc, char *argv[])
                     break;
             }
 
-            //CvScalar s;
-            //s = cvGet2D(img, 3, 3);
-            //cout << "s val: " << s.val[0] << endl;
-
-            cv::Mat matImg(img);
-            double sourcePlaneFeatureMapValues[] = 
-                        {
-                            1, 1, 2, 2,
-                            1, 1, 2, 2,
-                            3, 3, 4, 4,
-                            3, 3, 4, 4
-                        };
-            
-            // FOR TESTING
-            //CvMat cvmat = cvMat(4, 
-            //                            4, 
-            //                            CV_64FC1, 
-            //                            sourcePlaneFeatureMapValues);
-
-
-            CvMat *cvmat = cvCreateMat(img->height, img->width, CV_32FC1);
-
-            cvConvert(img, cvmat);
-            cv::Mat floatMat = cvmat;
-            floatMat -= 108.08409242f;
-            floatMat /= 255.0f;
-            //floatMat -= 109.799621582;
-            //floatMat /= 234.0f;
-            //
-            // normalise it
-            //matImg = (matImg - 107.609341755);// / 255.0;
-            // cout << matImg << endl;
-            IplImage newImage = matImg;
-
-
-            cout << setprecision( 8 ) << right << fixed;
-            cout << (double) cvmGet(cvmat, 0, 0) << endl;
-            //cout << (double) cvmGet(cvmat, 127, 127) << endl;
-            //for ( int row = 0; row < 128; ++ row )
-           // {
-            //    for ( int col = 0; col < 128; ++ col )
-             //   {
-             //       cout << setw( 5 ) 
-             //            << (double)cvmGet( cvmat, row, col ) 
-             //            << " ";
-             //   }
-             //  cout << endl;
-            //}
             // Forward propagate the grayscale (8 bit) image and get the value
             ostringstream val;
-            val << (float) net.fprop(cvmat);
+            if (normalise)
+            {
+                cvConvertScale(img, normalised, 1.0/255.0, -108.08409242/255.0);
+                val << (float) net.fprop(normalised);
+            }
+            else
+            {
+                val << (float) net.fprop(img);
+            }
             cout << val.str() << endl;
             // Make image colorful
-            cvCvtColor(&newImage,colorimg,CV_GRAY2RGB);
+            cvCvtColor(img,colorimg,CV_GRAY2RGB);
 
             // Draw green text for the recognized number on top of the image
             cvPutText(colorimg, val.str().c_str(), cvPoint(0,inputsz.height/2), &font, CV_RGB(0,255,0));
@@ -174,6 +144,7 @@ int main(int argc, char *argv[])
     }
     // Free buffers
     cvReleaseImage(&colorimg);
+    cvReleaseMat(&normalised);
 
     return 0;
 }
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of compute backend interface
+ * \date 2026
+ */
+
+#ifndef CVBACKEND_H
+#define CVBACKEND_H
+
+#include <opencv/cv.h>
+#include <string>
+#include <vector>
+
+//! Weights with at most this fraction of nonzeros are computed by the sparse primitives
+#define CV_SPARSE_DENSITY 0.5
+
+//! Activation functions known to backends
+enum
+{
+	CVCONVNET_ACT_IDENTITY = 0,	//!< f(x) = x
+	CVCONVNET_ACT_TANH = 1,		//!< f(x) = tanh(x)
+	CVCONVNET_ACT_STDSIGMOID = 2	//!< f(x) = DQstdsigmoid(x)
+};
+
+//! The class provides an interface to primitive operations used by planes
+/*! Planes don't do the math themselves, they invoke primitive
+ * operations of their backend. Different backends provide different 
+ * implementations of the same primitives, so a faster implementation 
+ * can be selected for the whole net or for an individual plane 
+ * without touching the planes or the model files.
+ * 
+ * All matrices are CV_64FC1. Operations that produce a feature map
+ * accumulate into the destination matrix and the size of the destination
+ * defines how many outputs are computed.
+ * 
+ * Backends are singletons obtained by cvGetBackend() and shared by
+ * all networks, so whatever they keep between calls is kept per thread.
+ */
+class CvBackend
+{
+public:
+		//! Destructor
+		virtual ~CvBackend ( );
+
+		//! Name of the backend
+		virtual std::string getname ( ) = 0;
+
+		//! acc(y,x) += sum of weight(j,k)*src(y+j,x+k) over neuron window
+		virtual void convolve(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc) = 0;
+
+		//! acc(y,x) += sum of weight(j,k)*src(y*stride.height+j,x*stride.width+k) over neuron window
+		virtual void convolvestrided(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc) = 0;
+
+		//! convolvestrided() of n planes reading the same src, acc[i] gets weight[i], all acc have the same size
+		virtual void convolvebank(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc) = 0;
+
+		//! convolvestrided() summed over channels interleaved in src: src(y,x*channels+c), weight ordered by (j,k,c)
+		virtual void convolvepacked(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc) = 0;
+
+		//! convolvestrided() with n nonzero weights only, at window positions tap[t] = j*neurosz.width+k
+		virtual void convolvesparse(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc) = 0;
+
+		//! convolvebank() visiting nonzero elements of src only, for sources that are mostly zero
+		virtual void convolvescatter(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc) = 0;
+
+		//! Same as convolvestrided() for windows starting at origin and clipped by src, outputs inside skip are untouched
+		virtual void convolveclipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc) = 0;
+
+		//! acc(y,x) += sum of weight[i]*src[i](y,x) over n feature maps
+		virtual void combine(const CvMat **src, const double *weight, int n, CvMat *acc) = 0;
+
+		//! dst(y,x*n+i) = src[i](y,x), the size of dst defines the region copied
+		virtual void interleave(const CvMat **src, int n, CvMat *dst) = 0;
+
+		//! acc(y,x) += sum of non-overlapping neuron window of src at (y,x)
+		virtual void sumpool(const CvMat *src, CvSize neurosz, CvMat *acc) = 0;
+
+		//! acc(y,x) = max of acc(y,x) and non-overlapping neuron window of src at (y,x)
+		virtual void maxpool(const CvMat *src, CvSize neurosz, CvMat *acc) = 0;
+
+		//! Dot product of weights and top-left neuron window of src
+		virtual double dense(const CvMat *src, const double *weight, CvSize neurosz) = 0;
+
+		//! Dot product of n nonzero weights and elements index[t] of continuous src
+		virtual double dotsparse(const CvMat *src, const int *index, const double *weight, int n) = 0;
+
+		//! Squared euclidean distance between weights and top-left neuron window of src
+		virtual double distance(const CvMat *src, const double *weight, CvSize neurosz) = 0;
+
+		//! fmap(y,x) = f(scale*fmap(y,x)+shift) for given activation f
+		virtual void activate(CvMat *fmap, int activation, double scale, double shift) = 0;
+
+		//! Index of the first maximum value
+		virtual int argmax(const double *val, int n) = 0;
+};
+
+//! Returns backend by its name ("reference", "simd" or "opencv")
+CvBackend *cvGetBackend(std::string name);
+
+//! Returns names of all available backends
+std::vector<std::string> cvGetBackendNames();
+
+//! Returns the backend planes use unless told otherwise
+CvBackend *cvGetDefaultBackend();
+
+#endif // CVBACKEND_H
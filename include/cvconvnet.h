@@ -51,6 +51,7 @@ preliminary and subject to change at any time, without notice.
 #include <map>
 
 class CvGenericPlane;
+class CvResultCache;
 
 
 //! The class represents the convolutional neural network
@@ -72,15 +73,72 @@ public:
 		//! Forward-propagation of input image through the whole network
 		double fprop (CvArr *input);
 
+		//! Forward-propagation of a region of a frame sampled into the source plane
+		double fprop (CvArr *frame, CvRect roi, int interp = CV_INTER_LINEAR);
+
+		//! Forward-propagation of input image that differs from the previous one only in given regions
+		double fprop (CvArr *input, const std::vector<CvRect> &dirty);
+
+		//! Forward-propagation of input image recomputing only regions changed since the previous input
+		double fpropincr (CvArr *input, double tolerance = 0.0);
+
+		//! Id of the plane that produced the result of the last fprop
+		std::string getexit ( );
+
+		//! Makes fprop look up results of repeated inputs in the cache
+		void setcache ( CvResultCache *cache );
+
+		//! Sets the input image without propagating it
+		int setinput (CvArr *input);
+
+		//! Sets a region of a frame as the input image without propagating it
+		int setinput (CvArr *frame, CvRect roi, int interp = CV_INTER_LINEAR);
+
+		//! Evaluates only the planes needed for the given plane
+		const CvMat * eval( std::string id );
+
+		//! Evaluates only the planes needed for the given planes
+		int eval( const std::vector<std::string> &ids );
+
 		//! Provides access to individual planes inside the network
 		const CvMat * getplane( std::string id );
 
+		//! Ids of all planes in the order of evaluation
+		std::vector<std::string> getids( );
+
+		//! Size of input images accepted by the network
+		CvSize getinputsz( );
+
+		//! Mean and scale the network applies to input pixels
+		int getnormalization( double &mean, double &scale );
+
+		//! Selects the compute backend for all planes of the network
+		int setbackend( std::string backend );
+
+		//! Selects the compute backend for an individual plane
+		int setbackend( std::string id, std::string backend );
+
+		//! Selects the fastest backend for each plane on this machine
+		int tune( std::string cachefile );
+
+		//! Sets weights of small magnitude to zero in all planes
+		int prune( double threshold );
+
+		//! Replaces convolution kernels by their low rank approximations
+		int approximate( double tolerance );
+
+		//! Removes a plane, its connections and the planes left without parents
+		int removeplane( std::string id );
+
 		//! Produces string representation of the convolutional net
 		std::string toString();
 
 		//! Creates the convolutional net from a string representation
 		int fromString ( std::string xml );
 
+		//! Produces self-contained C++ source of the convolutional net
+		int toCode ( std::string funcname, std::string &code );
+
 		//! Output of the network into stream
 		friend std::ostream& operator<< (std::ostream& s, CvConvNet& n);
 
@@ -88,9 +146,54 @@ public:
 		friend std::istream& operator>> (std::istream& s, CvConvNet& n);
 
 protected:
+		//! Propagates the input set by setinput() checking cache and exit points
+		double propagate( );
+
+		//! Evaluates the plane and all its ancestors that are not valid yet
+		void evalplane( int idx );
+
+		//! Recomputes given regions of the source plane and everything depending on them
+		void fpropdirty( const std::vector<CvRect> &dirty );
+
+		//! Checks whether every plane holds the result for the current input
+		int isvalid( );
+
+		//! Links planes to indices of their parents after loading
+		int link( );
+
+		//! Makes groups of planes of type T with the same parents computed together
+		template <class T> void share( );
+
+		//! Makes banks of convolutional planes of the same shape computed together
+		void sharebanks( );
+
+		//! Records that the first plane of the group computes the others
+		void addgroup( const std::vector<int> &idx );
+
 		//! The container of the planes
 		std::vector<CvGenericPlane *> m_plane;
 
+		//! Indices of parents of every plane
+		std::vector< std::vector<int> > m_parent;
+
+		//! Index of the plane computing every plane (the plane itself unless it is in a group)
+		std::vector<int> m_leader;
+
+		//! Planes whose parents every plane reads (the group for a leader, the plane itself otherwise)
+		std::vector< std::vector<int> > m_member;
+
+		//! Flags whether the plane's feature map is computed for current input
+		std::vector<int> m_valid;
+
+		//! Early exit planes with their confidence thresholds, in order of checking
+		std::vector< std::pair<std::string,double> > m_exit;
+
+		//! Index of the plane that produced the result of the last fprop
+		int m_exitidx;
+
+		//! Cache of results for repeated inputs (not owned)
+		CvResultCache *m_cache;
+
 		//! Hash table mapping string ids into int ids
 		std::map<std::string, int> m_idmap; 
 
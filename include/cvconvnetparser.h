@@ -58,6 +58,7 @@ int parse(std::string xml, std::string &creator,
 		std::string &name, 
 		std::string &info, 
  		std::vector<CvGenericPlane *> &plane,
-		std::map<std::string,int> &idmap);
+		std::map<std::string,int> &idmap,
+		std::vector< std::pair<std::string,double> > &exits);
 
 #endif // CVCONVNETPARSER_H
@@ -43,8 +43,33 @@ preliminary and subject to change at any time, without notice.
 
 #include <opencv/cv.h>
 #include <string>
+#include <vector>
 #include "cvgenericplane.h"
 
+//! Relative error of a kernel's low rank form below which the form is used instead of the kernel
+#define CV_FACTOR_EPSILON 1e-12
+
+//! Fraction of nonzero pixels of a source plane below which outputs are scattered from the nonzero pixels
+/*! Padded MNIST digits have about 0.15 on average, the threshold is kept
+ * clear of it so that typical digits do not switch paths from image to image.
+ */
+#define CV_SCATTER_DENSITY 0.1
+
+//! Layouts of parents' feature maps read by convolutional planes
+enum
+{
+	CVCONVNET_LAYOUT_PLANAR = 0,	//!< every parent is read from its own feature map
+	CVCONVNET_LAYOUT_HWC = 1	//!< parents are interleaved into one map, channel is the fastest index
+};
+
+//! Forms in which kernels of parents are computed
+enum
+{
+	CVCONVNET_KERNEL_ZERO = 0,	//!< pruned completely, skipped
+	CVCONVNET_KERNEL_DENSE = 1,	//!< the whole window, by the bank
+	CVCONVNET_KERNEL_SPARSE = 2,	//!< the nonzero weights only, by convolvesparse()
+	CVCONVNET_KERNEL_FACTORED = 3	//!< a row and a column pass per term of the separable form
+};
 
 //! The class represents an individual convolutional neuron
 /*! Convolutional planes are planes that take a weighted sum
@@ -61,19 +86,146 @@ public:
 		// Constructors/Destructors
 		//  
 		//! Constructor
-		CvConvolutionPlane (std::string id, CvSize fmapsz, CvSize neurosz);
+		CvConvolutionPlane (std::string id, CvSize fmapsz, CvSize neurosz, CvSize stride = cvSize(1,1), CvSize padding = cvSize(0,0));
 
 		//! Destructor
 		virtual ~CvConvolutionPlane ( );
 
+		//! Connects the plane to its parents
+		virtual int connto ( std::vector<CvGenericPlane *> &pplane );
+
 		//! Forward propagation from parent planes.
 		virtual CvMat * fprop ( );
 
+		//! Forward propagation of a region of the feature map
+		virtual CvMat * fpropregion ( CvRect rect );
+
+		//! Region of the feature map depending on the given region of a parent
+		virtual CvRect getdirtyrect ( CvRect prect );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
+		//! Stride, padding and forms of the kernels of the bank
+		virtual std::string getform ( );
+
 		//! Produces string representation of the convolutional plane
 		virtual std::string toString ( );
 
+		//! Produces C++ code of the convolutional plane
+		virtual std::string toCode ( );
+
 		//! Explicitly set the weights for the plane's neuron
 		virtual int setweight(std::vector<double> &weights);
+
+		//! Sets weights of small magnitude to zero
+		virtual int prune ( double threshold );
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Replaces kernels by their low rank approximations within the tolerance
+		virtual int approximate ( double tolerance );
+
+		//! Distance between neuron windows of neighbouring outputs
+		CvSize getstride ( );
+
+		//! Implicit zero padding of parents' feature maps
+		CvSize getpadding ( );
+
+		//! Makes the plane compute feature maps of the whole group
+		int share ( std::vector<CvConvolutionPlane *> &group );
+
+		//! Selects the layout in which parents are read (CVCONVNET_LAYOUT_*)
+		int setlayout ( int layout );
+
+		//! Layout in which parents are read
+		int getlayout ( );
+
+protected:
+		//! Form in which the kernel of a parent is computed (CVCONVNET_KERNEL_*)
+		int getkernelform ( int i );
+
+		//! Adds contribution of a parent of the bank to a region of the feature maps of the bank
+		void accumulate ( int u, CvRect rect, CvMat *region );
+
+		//! Adds contribution of a factored kernel of a plane of the bank
+		void accumulatefactored ( const CvMat *src, CvConvolutionPlane *plane, int i, CvMat *acc );
+
+		//! Adds contribution of all parents of the bank interleaved into one map
+		void accumulatepacked ( CvRect rect, CvMat *region );
+
+		//! Region of the feature map whose neuron windows lie inside the parent
+		CvRect getinterior ( CvMat *pfmap, CvRect rect );
+
+		//! Reorders the weights for interleaved parents
+		void packweights ( );
+
+		//! Builds compressed form of the kernels
+		void compress ( );
+
+		//! Builds separable form of the kernels of low rank
+		void factor ( );
+
+		//! Builds separable form of the kernel of a parent if it is of low rank
+		void factor ( int i );
+
+		//! Singular value decomposition of a kernel into rank one terms
+		void decompose ( int i, std::vector<double> &sigma, std::vector<double> &column, std::vector<double> &row );
+
+		//! Whether separable form of the given rank is cheaper than the kernel
+		int isfactorable ( int rank, int nnz );
+
+		//! Distance between neuron windows of neighbouring outputs
+		CvSize m_stride;
+
+		//! Implicit zero padding of parents' feature maps
+		CvSize m_padding;
+
+		//! Activation function applied to the weighted sum (CVCONVNET_ACT_*)
+		int m_activation;
+
+		//! Plane computing the feature map of this plane
+		CvConvolutionPlane *m_leader;
+
+		//! Planes computed by this plane (itself first), empty if computed by another plane
+		std::vector<CvConvolutionPlane *> m_bank;
+
+		//! Feature maps of parents of all planes of the bank
+		std::vector<CvMat *> m_bankfmap;
+
+		//! Connections of every parent of the bank as pairs (plane of the bank, index of parent in the plane)
+		std::vector< std::vector< std::pair<int,int> > > m_link;
+
+		//! Index of every parent of the plane in parents of the leader's bank
+		std::vector<int> m_channel;
+
+		//! Flags of parents of the bank that are source planes, whose density is checked by accumulate()
+		std::vector<int> m_sourceparent;
+
+		//! Layout in which parents are read (CVCONVNET_LAYOUT_*)
+		int m_layout;
+
+		//! Parents interleaved for CVCONVNET_LAYOUT_HWC
+		CvMat *m_packed;
+
+		//! Weights without bias ordered by row, column and parent of the bank
+		std::vector<double> m_hwcweight;
+
+		//! Positions of nonzero weights in the window for every parent
+		std::vector< std::vector<int> > m_tap;
+
+		//! Nonzero weights for every parent
+		std::vector< std::vector<double> > m_tapweight;
+
+		//! Column factors (scaled by singular values) of separable kernels for every parent, empty if not factored
+		std::vector< std::vector<double> > m_column;
+
+		//! Row factors of separable kernels for every parent, empty if not factored
+		std::vector< std::vector<double> > m_row;
+
+		//! Rows of a parent convolved by a row factor
+		CvMat *m_scratch;
 };
 
 #endif // CVCONVOLUTIONPLANE_H
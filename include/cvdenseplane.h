@@ -0,0 +1,135 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of dense plane class
+ * \date 2026
+ */
+
+#ifndef CVDENSEPLANE_H
+#define CVDENSEPLANE_H
+
+#include <opencv/cv.h>
+#include <string>
+#include <vector>
+#include "cvgenericplane.h"
+
+//! The class represents a fully-connected layer of regression neurons
+/*! Dense planes compute several outputs, each of them is a weighted
+ * sum of the top-left neuron windows of all parents plus a bias, like 
+ * the output of a regression plane. The feature map is a single row 
+ * with one value per output.
+ * 
+ * Neuron windows of all parents are gathered into one row x first,
+ * so the parents are read once, and then every output is a dot product 
+ * of x with a contiguous row of weights, or with the nonzero weights of 
+ * the row only if most of them are pruned (see prune()).
+ * 
+ * In XML the bias tag holds one bias per output and every connection 
+ * holds the neuron windows of all outputs one after another.
+ * Groups of regression planes sharing their parents are computed
+ * by a dense plane too (see CvRegressionPlane::share()).
+ */
+class CvDensePlane : public CvGenericPlane
+{
+public:
+
+		// Constructors/Destructors
+		//  
+		//! Constructor
+		CvDensePlane (std::string id, int noutputs, CvSize neurosz);
+
+		//! Destructor
+		virtual ~CvDensePlane ( );
+
+		//! Connect the plane to the parent planes
+		virtual int connto(std::vector<CvGenericPlane *> &pplane);
+
+		//! Connect the plane to the parent planes without being their child
+		int connhidden(std::vector<CvGenericPlane *> &pplane);
+
+		//! Forward propagation from parent planes.
+		virtual CvMat * fprop ( );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
+		//! Produces string representation of the dense plane
+		virtual std::string toString ( );
+
+		//! Produces C++ code of the dense plane
+		virtual std::string toCode ( );
+
+		//! Explicitly set the weights for all outputs (in XML order)
+		virtual int setweight(std::vector<double> &weights);
+
+		//! Set the bias and weights of one output (in regression plane order)
+		int setrow(int output, const std::vector<double> &weights);
+
+		//! Sets weights of small magnitude to zero
+		virtual int prune ( double threshold );
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Number of outputs
+		int getoutputs ( );
+
+		//! Number of outputs computed from their nonzero weights only
+		virtual std::string getform ( );
+
+protected:
+		//! Connects the plane and allocates the input row and the weights
+		int connect(std::vector<CvGenericPlane *> &pplane, int child);
+
+		//! Number of weights of one output including the bias
+		int getrowsz ( );
+
+		//! Whether an output is computed from its nonzero weights only
+		int issparse ( int output );
+
+		//! Builds compressed form of the weights of an output
+		void compress ( int output );
+
+		//! Neuron windows of all parents as a single row
+		CvMat *m_x;
+
+		//! Indices of nonzero weights in the row for every output
+		std::vector< std::vector<int> > m_index;
+
+		//! Nonzero weights for every output
+		std::vector< std::vector<double> > m_value;
+};
+
+#endif // CVDENSEPLANE_H
@@ -44,6 +44,10 @@ preliminary and subject to change at any time, without notice.
 #include <opencv/cv.h>
 #include <string>
 #include <vector>
+#include "cvbackend.h"
+
+//! Significant digits of weights in XML, enough to read back the same double
+#define CVCONVNET_XML_PRECISION 17
 
 //! The class provides a generic interface that every plane (neuron) must implement
 /*! The class provides a generic interface that every plane must implement, 
@@ -66,7 +70,7 @@ public:
 		virtual ~CvGenericPlane ( );
 
 		//! Connect the plane to the parent planes
-		int connto(std::vector<CvGenericPlane *> &pplane);
+		virtual int connto(std::vector<CvGenericPlane *> &pplane);
 
 		//! Connect the plane back to child
 		int connchild(CvGenericPlane *cplane);
@@ -77,25 +81,76 @@ public:
 		//! Do forward propagation
 		virtual CvMat * fprop ( ) = 0;
 
+		//! Do forward propagation of a region of the feature map only
+		virtual CvMat * fpropregion ( CvRect rect );
+
+		//! Region of the feature map depending on the given region of parent's feature map
+		virtual CvRect getdirtyrect ( CvRect prect );
+
 		// Do backward error propagation
 // 		virtual CvMat * bprop ( ) = 0;
 
+		//! Confidence of the plane's output
+		virtual double getconfidence ( );
+
+		//! Form in which the plane computes its output, beyond its shape
+		virtual std::string getform ( );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( ) = 0;
+
 		//! Produce string representation
 		virtual std::string toString ( ) = 0;
 
+		//! Produce C++ code computing the plane's feature map
+		virtual std::string toCode ( ) = 0;
+
 		//! Explicitly set the weights for the plane's neuron
 		virtual int setweight(std::vector<double> &weights);
 
+		//! Sets weights of small magnitude to zero
+		virtual int prune ( double threshold );
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Replaces kernels by their low rank approximations within the tolerance
+		virtual int approximate ( double tolerance );
+
 		//! Get a pointer to plane's feature map
 		CvMat * getfmap ( );
 
 		//! Explicitly set values for plane's feature map
-		int setfmap ( CvArr * source );
+		virtual int setfmap ( CvArr * source );
 
 		//! Get plane's text id
 		std::string getid();
 
+		//! Get plane's id as an identifier usable in generated code
+		std::string getsymbol();
+
+		//! Get the weights of the plane's neuron
+		const std::vector<double> & getweight();
+
+		//! Get the size of neuron window
+		CvSize getneurosz();
+
+		//! Get the parents of the plane
+		const std::vector<CvGenericPlane *> & getparents();
+
+		//! Select the backend computing the plane
+		int setbackend(CvBackend *backend);
+
+		//! Get the backend computing the plane
+		CvBackend * getbackend();
+
 protected:
+		//! Sets the parents without connecting back to them as their child
+		int setparents ( std::vector<CvGenericPlane *> &pplane );
+
+		//! Sets weights from index first on of small magnitude to zero by setweight()
+		int pruneweights ( double threshold, int first );
+
 		std::string m_id; //!< Plane string id
 		std::vector<CvGenericPlane *> m_pplane; //!< Links to parents (for fprop)
 		std::vector<CvGenericPlane *> m_cplane; //!< Links to childs (for bprop)
@@ -108,6 +163,7 @@ protected:
 
 		std::vector<double> m_weight; //!< Container for weights of plane's neuron 
 		int m_connected; //!< Flag specifying whether we are already connected to parents or not
+		CvBackend *m_backend; //!< Backend doing the math for fprop
 };
 
 #endif // CVGENERICPLANE_H
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of low-level kernels used by planes
+ *
+ * Every kernel works on CV_64FC1 matrices and accumulates its result
+ * into the destination matrix, so that a plane with several parents 
+ * can just invoke the kernel once per parent.
+ * The size of the destination matrix defines how many outputs are computed.
+ * \date 2026
+ */
+
+#ifndef CVKERNELS_H
+#define CVKERNELS_H
+
+#include <opencv/cv.h>
+
+//! Convolution kernel: acc(y,x) += sum of weight(j,k)*src(y+j,x+k)
+typedef void (*CvConvKernel)(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc);
+
+//! Strided convolution kernel: acc(y,x) += sum of weight(j,k)*src(y*stride.height+j,x*stride.width+k)
+typedef void (*CvStridedConvKernel)(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc);
+
+//! Pooling kernel over non-overlapping windows starting at (y*neurosz.height,x*neurosz.width)
+typedef void (*CvPoolKernel)(const CvMat *src, CvSize neurosz, CvMat *acc);
+
+//! Convolution for any neuron window
+void icvConvolveGeneric(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc);
+
+//! Strided convolution for any neuron window
+void icvConvolveStridedGeneric(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc);
+
+//! Strided convolution of n planes with the same source: acc[i](y,x) += sum of weight[i](j,k)*src(y*stride.height+j,x*stride.width+k)
+void icvConvolveBankGeneric(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc);
+
+//! Convolution of border outputs whose neuron window sticks out of src (zeros are assumed there)
+void icvConvolveClipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc);
+
+//! Strided convolution of channels interleaved in src (weight is ordered by row, column, channel)
+void icvConvolvePackedGeneric(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc);
+
+//! Interleaves n maps into one: dst(y,x*n+i) = src[i](y,x)
+void icvInterleave(const CvMat **src, int n, CvMat *dst);
+
+//! Strided convolution with n nonzero weights at window positions tap[t] = j*neurosz.width+k
+void icvConvolveSparseGeneric(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc);
+
+//! Strided convolution of n planes computed from nonzero elements of src only
+void icvConvolveScatterGeneric(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc);
+
+//! Weighted sum of feature maps: acc(y,x) += sum of weight[i]*src[i](y,x)
+void icvCombineGeneric(const CvMat **src, const double *weight, int n, CvMat *acc);
+
+//! Sum pooling for any neuron window
+void icvSumPoolGeneric(const CvMat *src, CvSize neurosz, CvMat *acc);
+
+//! Max pooling for any neuron window
+void icvMaxPoolGeneric(const CvMat *src, CvSize neurosz, CvMat *acc);
+
+//! Dot product of weights and top-left neuron window of src
+double icvDotGeneric(const CvMat *src, const double *weight, CvSize neurosz);
+
+//! Dot product of n nonzero weights and elements index[t] of continuous src
+double icvDotSparseGeneric(const CvMat *src, const int *index, const double *weight, int n);
+
+//! Squared euclidean distance between weights and top-left neuron window of src
+double icvDistGeneric(const CvMat *src, const double *weight, CvSize neurosz);
+
+//! fmap(y,x) = f(scale*fmap(y,x)+shift) for given activation f
+void icvActivate(CvMat *fmap, int activation, double scale, double shift);
+
+//! Index of the first maximum value
+int icvArgmax(const double *val, int n);
+
+//! Returns the fastest convolution kernel for the given neuron window
+CvConvKernel icvGetConvKernel(CvSize neurosz);
+
+//! Returns the fastest strided convolution kernel for the given neuron window
+CvStridedConvKernel icvGetStridedConvKernel(CvSize neurosz);
+
+//! Returns the fastest kernel summing non-overlapping windows into acc
+CvPoolKernel icvGetSumPoolKernel(CvSize neurosz);
+
+//! Returns the fastest kernel taking maximum of acc and non-overlapping windows
+CvPoolKernel icvGetMaxPoolKernel(CvSize neurosz);
+
+#endif // CVKERNELS_H
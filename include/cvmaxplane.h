@@ -48,7 +48,9 @@ preliminary and subject to change at any time, without notice.
 
 //! The class represents a search for maximum value in output neurons
 /*! Max planes are just a data abstraction for searching maximum value 
- * among output level neurons.
+ * among output level neurons. Max planes can also search for the minimum
+ * value, which is what RBF output neurons need (the closest class wins).
+ * A max plane connected to a single dense plane searches among its outputs.
  */
 class CvMaxPlane : public CvGenericPlane
 {
@@ -56,7 +58,7 @@ public:
 
 	// Constructors/Destructors
 	//! Constructor
-	CvMaxPlane (std::string id) ;
+	CvMaxPlane (std::string id, int minimum = 0) ;
 
 	//! Destructor
 	virtual ~CvMaxPlane ( );
@@ -64,15 +66,30 @@ public:
 	//! Forward propagation from parent planes.
 	virtual CvMat * fprop ( );
 
+	//! Value of the winning parent
+	virtual double getconfidence ( );
+
+	//! Type of the plane as used in XML
+	virtual std::string gettype ( );
+
 	//! Produces string representation of the convolutional plane
 	virtual std::string toString ( );
 
+	//! Produces C++ code of the max plane
+	virtual std::string toCode ( );
+
 	//! Prohibit to set any weight
 	virtual int setweight(std::vector<double> &weights);
 
+	//! Prohibit to remove any parent
+	virtual int removeparent ( int i );
+
 protected:
-	//! Storage of parent featuremap values
+	//! Storage of parent featuremap values (negated when searching for minimum)
 	std::vector<double> m_parentval;
+
+	//! Whether the plane searches for minimum instead of maximum
+	int m_minimum;
 	CvMat *m_intfmap;
 };
 
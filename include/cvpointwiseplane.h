@@ -0,0 +1,118 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of pointwise plane class
+ * \date 2026
+ */
+
+#ifndef CVPOINTWISEPLANE_H
+#define CVPOINTWISEPLANE_H
+
+#include <opencv/cv.h>
+#include <string>
+#include <vector>
+#include "cvgenericplane.h"
+
+//! The class represents an individual pointwise (1x1 convolution) neuron
+/*! Pointwise planes take a weighted sum of their parents at the same 
+ * position, add a bias and pass it through tanh, i.e. they are 
+ * convolutional planes with 1x1 neuron window. The weighted sum of all 
+ * parents, the bias and the activation are computed in a single pass
+ * over the feature map instead of one pass per parent.
+ *
+ * Pointwise planes with the same parents can form a group (see share()).
+ * The first plane of the group, the leader, computes all of them in one
+ * pass over the parents: every row of the parents is combined into the
+ * rows of all planes of the group while it is in cache. fprop of other
+ * planes of the group does nothing.
+ *
+ * Usually the parents are depthwise planes (see CvDepthwisePlane).
+ * Their feature maps are computed in full and not fused into the pass 
+ * of the pointwise plane: every pointwise plane of a layer reads every
+ * depthwise map, so fusing would compute each depthwise map once per
+ * pointwise plane instead of once.
+ * All parents must have the feature map of the plane's size.
+ */
+class CvPointwisePlane : public CvGenericPlane
+{
+public:
+
+		// Constructors/Destructors
+		//  
+		//! Constructor
+		CvPointwisePlane (std::string id, CvSize fmapsz);
+
+		//! Destructor
+		virtual ~CvPointwisePlane ( );
+
+		//! Forward propagation from parent planes.
+		virtual CvMat * fprop ( );
+
+		//! Forward propagation of a region of the feature map
+		virtual CvMat * fpropregion ( CvRect rect );
+
+		//! Region of the feature map depending on the given region of a parent
+		virtual CvRect getdirtyrect ( CvRect prect );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
+		//! Produces string representation of the pointwise plane
+		virtual std::string toString ( );
+
+		//! Produces C++ code of the pointwise plane
+		virtual std::string toCode ( );
+
+		//! Explicitly set the weights for the plane's neuron
+		virtual int setweight(std::vector<double> &weights);
+
+		//! Sets weights of small magnitude to zero
+		virtual int prune ( double threshold );
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Makes the plane compute the whole group
+		int share ( std::vector<CvPointwisePlane *> &group );
+
+protected:
+		//! Plane computing this one
+		CvPointwisePlane *m_leader;
+
+		//! Planes computed by this one, the leader first (leader only)
+		std::vector<CvPointwisePlane *> m_group;
+};
+
+#endif // CVPOINTWISEPLANE_H
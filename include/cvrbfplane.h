@@ -42,10 +42,21 @@ preliminary and subject to change at any time, without notice.
 
 #include <opencv/cv.h>
 #include <string>
+#include <vector>
 #include "cvgenericplane.h"
 
 //! The class represents an individual RBF neuron
-/*! For RBF (Radial Basis Function) planes please refer to google
+/*! RBF (Radial Basis Function) planes output the squared euclidean 
+ * distance between their weights and the neuron window of the parents,
+ * as the output layer of LeNet-5 does. The closest class wins, so RBF 
+ * outputs are meant to be connected to a max plane selecting the minimum.
+ * 
+ * Output RBF planes (1x1 feature map) sharing the same parents can form
+ * a group (see share()). The first plane of the group, the leader, 
+ * computes distances of all of them at once by expanding 
+ * ||x-w||^2 = ||x||^2 - 2 w.x + ||w||^2, where ||w||^2 are precomputed,
+ * so each plane costs a single dot product. fprop of other planes 
+ * of the group does nothing.
  * 
  * Each plane object represents one neuron (not a layer!).
  * The object also contains weights for this neuron and feature map
@@ -66,11 +77,42 @@ public:
 		//! Forward propagation from parent planes.
 		virtual CvMat * fprop ( );
 
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
 		//! Produces string representation of the RBF plane
 		virtual std::string toString ( );
 
+		//! Produces C++ code of the RBF plane
+		virtual std::string toCode ( );
+
 		//! Explicitly set the weights for the plane's neuron
 		virtual int setweight(std::vector<double> &weights);	
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Makes the plane compute distances of the whole group
+		int share ( std::vector<CvRBFPlane *> &group );
+
+protected:
+		//! Computes distances of all planes of the group
+		void fpropgroup ( );
+
+		//! Plane computing the distance of this one
+		CvRBFPlane *m_leader;
+
+		//! Planes whose distances are computed by this one (leader only)
+		std::vector<CvRBFPlane *> m_group;
+
+		//! Squared norms of weights of the group (leader only)
+		std::vector<double> m_norm;
+
+		//! Set when weights of the group changed since norms were computed
+		int m_stale;
+
+		//! Neuron windows of all parents as a single row (leader only)
+		CvMat *m_x;
 };
 
 
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of reference backend
+ * \date 2026
+ */
+
+#ifndef CVREFERENCEBACKEND_H
+#define CVREFERENCEBACKEND_H
+
+#include <opencv/cv.h>
+#include <string>
+#include "cvbackend.h"
+
+//! The class implements primitive operations with plain loops
+/*! The backend is the slowest one, it exists to verify
+ * the results of other backends.
+ */
+class CvReferenceBackend : public CvBackend
+{
+public:
+		//! Name of the backend
+		virtual std::string getname ( );
+
+		//! Convolution over neuron window
+		virtual void convolve(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc);
+
+		//! Convolution computing every stride-th output only
+		virtual void convolvestrided(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc);
+
+		//! Strided convolution of several planes reading the same parent
+		virtual void convolvebank(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc);
+
+		//! Strided convolution of interleaved parents
+		virtual void convolvepacked(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc);
+
+		//! Strided convolution with nonzero weights only
+		virtual void convolvesparse(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc);
+
+		//! Strided convolution of several planes from nonzero elements of the parent
+		virtual void convolvescatter(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc);
+
+		//! Convolution of border outputs with neuron window clipped by parent
+		virtual void convolveclipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc);
+
+		//! Weighted sum of feature maps
+		virtual void combine(const CvMat **src, const double *weight, int n, CvMat *acc);
+
+		//! Interleaving of feature maps into one
+		virtual void interleave(const CvMat **src, int n, CvMat *dst);
+
+		//! Sum over non-overlapping neuron windows
+		virtual void sumpool(const CvMat *src, CvSize neurosz, CvMat *acc);
+
+		//! Maximum over non-overlapping neuron windows
+		virtual void maxpool(const CvMat *src, CvSize neurosz, CvMat *acc);
+
+		//! Dot product of weights and neuron window
+		virtual double dense(const CvMat *src, const double *weight, CvSize neurosz);
+
+		//! Dot product with nonzero weights only
+		virtual double dotsparse(const CvMat *src, const int *index, const double *weight, int n);
+
+		//! Squared distance between weights and neuron window
+		virtual double distance(const CvMat *src, const double *weight, CvSize neurosz);
+
+		//! Activation of the feature map
+		virtual void activate(CvMat *fmap, int activation, double scale, double shift);
+
+		//! Index of the first maximum value
+		virtual int argmax(const double *val, int n);
+};
+
+#endif // CVREFERENCEBACKEND_H
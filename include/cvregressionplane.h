@@ -45,11 +45,17 @@ preliminary and subject to change at any time, without notice.
 #include <string>
 #include "cvgenericplane.h"
 
+class CvDensePlane;
 
 //! The class represents an individual regression neuron
 /*! Regression planes are planes that take a weighted sum
  * of their input.
  * 
+ * Regression planes sharing their parents can form a group (see share()),
+ * which is computed by a single dense plane owned by the first plane
+ * of the group, the leader. The planes of the group become views 
+ * of the dense plane's outputs.
+ * 
  * Each plane object represents one neuron (not a layer!).
  * The object also contains weights for this neuron and feature map
  * for this neuron.
@@ -69,11 +75,39 @@ public:
 		//! Forward propagation from parent planes.
 		virtual CvMat * fprop ( );
 
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
+		//! Form of the dense plane of the group computed by the plane
+		virtual std::string getform ( );
+
 		//! Produces string representation of the regression plane
 		virtual std::string toString ( );
 
+		//! Produces C++ code of the regression plane
+		virtual std::string toCode ( );
+
 		//! Explicitly set the weights for the plane's neuron
 		virtual int setweight(std::vector<double> &weights);
+
+		//! Sets weights of small magnitude to zero
+		virtual int prune ( double threshold );
+
+		//! Removes the connection to a parent together with its weights
+		virtual int removeparent ( int i );
+
+		//! Makes the plane compute the whole group by a dense plane
+		int share ( std::vector<CvRegressionPlane *> &group );
+
+protected:
+		//! Plane owning the dense plane of the group
+		CvRegressionPlane *m_leader;
+
+		//! Dense plane computing the group (NULL when not grouped)
+		CvDensePlane *m_dense;
+
+		//! Index of the plane's output in the dense plane
+		int m_output;
 };
 
 #endif // CVREGRESSIONPLANE_H
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Declaration of result cache class
+ * \date 2026
+ */
+
+#ifndef CVRESULTCACHE_H
+#define CVRESULTCACHE_H
+
+#include <opencv/cv.h>
+#include <list>
+#include <map>
+#include <mutex>
+
+//! The class represents a bounded cache of network results for repeated inputs
+/*! The cache maps a hash of the source plane into the result of fprop
+ * (and the plane the result came from). Every entry keeps a copy of 
+ * the source plane as well, so an input whose hash collides with 
+ * a cached one is not taken for it. When full, the least recently
+ * used entry is dropped.
+ * 
+ * All methods are safe to call from several threads, so one cache can
+ * be shared by several CvConvNet objects loaded from the same model 
+ * (for instance one per thread). It must not be shared by different models.
+ */
+class CvResultCache
+{
+public:
+		//! Constructor
+		CvResultCache ( int capacity );
+
+		//! Destructor
+		virtual ~CvResultCache ( );
+
+		//! Looks up the result for the given input
+		int lookup ( uint64 key, const CvMat *input, double &value, int &planeidx );
+
+		//! Stores the result for the given input
+		void store ( uint64 key, const CvMat *input, double value, int planeidx );
+
+		//! Drops all entries and resets counters
+		void clear ( );
+
+		//! Number of successful lookups
+		long gethits ( );
+
+		//! Number of failed lookups
+		long getmisses ( );
+
+		//! Fraction of successful lookups
+		double gethitrate ( );
+
+		//! Hash of feature map values
+		static uint64 hash ( const CvMat *fmap );
+
+protected:
+		//! Cached result
+		typedef struct
+		{
+			uint64 key; //!< Hash of the input
+			CvMat *input; //!< Copy of the input
+			double value; //!< Result of fprop
+			int planeidx; //!< Index of the plane that produced the result
+		} CvResultCacheEntry;
+
+		int m_capacity; //!< Maximum number of entries
+		std::list<CvResultCacheEntry> m_lru; //!< Entries, most recently used first
+		std::map<uint64, std::list<CvResultCacheEntry>::iterator> m_index; //!< Key to entry mapping
+		long m_hits; //!< Number of successful lookups
+		long m_misses; //!< Number of failed lookups
+		std::mutex m_mutex; //!< Guards all members
+
+		//! Whether the values of two feature maps are the same
+		static int isequal ( const CvMat *a, const CvMat *b );
+};
+
+#endif // CVRESULTCACHE_H
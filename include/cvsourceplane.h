@@ -42,6 +42,7 @@ preliminary and subject to change at any time, without notice.
 
 #include <opencv/cv.h>
 #include <string>
+#include <vector>
 #include "cvgenericplane.h"
 
 //! The class represents the source image as a plane in the network
@@ -67,10 +68,42 @@ public:
 		//! Dummy Forward propagation 
 		virtual CvMat * fprop ( );
 
+		//! Set input preprocessing done by setfmap()
+		int setpreprocessing ( int padding, double mean, double scale, std::string inputtype );
+
+		//! Size of input images accepted by setfmap()
+		CvSize getinputsz ( );
+
+		//! Mean and scale applied to input pixels by setfmap()
+		void getnormalization ( double &mean, double &scale );
+
+		//! Preprocess the input image into plane's feature map
+		virtual int setfmap ( CvArr * source );
+
+		//! Samples a region of a frame into plane's feature map
+		int setfmap ( CvArr * frame, CvRect roi, int interp );
+
+		//! Region of the feature map holding the given region of input image
+		virtual CvRect getdirtyrect ( CvRect prect );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
 
 		//! Produces string representation of the source plane
 		virtual std::string toString ( );
 
+		//! Produces C++ code of the source plane
+		virtual std::string toCode ( );
+
+protected:
+		int m_padding; //!< Width of the border around input image
+		double m_mean; //!< Value subtracted from input pixels
+		double m_scale; //!< Factor applied to input pixels after mean subtraction
+		std::string m_inputtype; //!< Expected type of input pixels ("any", "uint8", "float32", "float64")
+
+		std::vector<int> m_xofs; //!< Sampling table: frame column for every feature map column
+		std::vector<double> m_xalpha; //!< Sampling table: weight of the next column
+		std::vector<double> m_rowbuf; //!< Grey values of the frame rows being sampled
 };
 
 #endif // CVSOURCEPLANE_H
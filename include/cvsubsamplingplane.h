@@ -70,9 +70,21 @@ public:
 		//! Forward propagation from parent planes.
 		virtual CvMat * fprop ( );
 
+		//! Forward propagation of a region of the feature map
+		virtual CvMat * fpropregion ( CvRect rect );
+
+		//! Region of the feature map depending on the given region of a parent
+		virtual CvRect getdirtyrect ( CvRect prect );
+
+		//! Type of the plane as used in XML
+		virtual std::string gettype ( );
+
 		//! Produces string representation of the convolutional plane
 		virtual std::string toString ( );
 
+		//! Produces C++ code of the subsampling plane
+		virtual std::string toCode ( );
+
 		//! Explicitly set the weights for the plane's neuron
 		virtual int setweight(std::vector<double> &weights);
 
@@ -41,7 +41,9 @@ preliminary and subject to change at any time, without notice.
  * \date 2007
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include "cvconvnet.h"
@@ -50,9 +52,38 @@ preliminary and subject to change at any time, without notice.
 #include "cvsubsamplingplane.h"
 #include "cvgenericplane.h"
 #include "cvrbfplane.h"
+#include "cvregressionplane.h"
+#include "cvpointwiseplane.h"
 #include "cvconvnetparser.h"
+#include "cvconvnetcompiler.h"
+#include "cvconvnettuner.h"
+#include "cvresultcache.h"
 
 using namespace std;
+
+/*! The function adds a rectangle to the list merging it with 
+ * every rectangle of the list it overlaps with.
+ * \param list list of non-overlapping rectangles
+ * \param r rectangle to be added
+ */
+static void icvAddRect(vector<CvRect> &list, CvRect r)
+{
+	for (int i = 0; i < list.size(); i++)
+	{
+		CvRect &l = list[i];
+		if (r.x < l.x+l.width && l.x < r.x+r.width && r.y < l.y+l.height && l.y < r.y+r.height)
+		{
+			int x0 = MIN(r.x, l.x), y0 = MIN(r.y, l.y);
+			int x1 = MAX(r.x+r.width, l.x+l.width), y1 = MAX(r.y+r.height, l.y+l.height);
+
+			r = cvRect(x0, y0, x1-x0, y1-y0);
+			list.erase(list.begin()+i);
+			i = -1; // The union may overlap with rectangles already checked
+		}
+	}
+	list.push_back(r);
+}
+
 // Constructors/Destructors
 //  
 
@@ -61,6 +92,8 @@ CvConvNet::CvConvNet ( )
 	m_creator = "undefined";
 	m_name = "untitled";
 	m_info = "";
+	m_exitidx = -1;
+	m_cache = NULL;
 }
 
 CvConvNet::~CvConvNet ( )
@@ -81,10 +114,299 @@ CvConvNet::~CvConvNet ( )
 /*! The method propagates the input image through the whole network
  * updating planes (feature maps) of each individual neuron.
  * Each plane values can be accessed after fprop for further analysis.
+ *
+ * If the network has exit points, they are checked in the order
+ * of definition first. Only the ancestors of an exit plane are evaluated
+ * and if the plane's confidence reaches the threshold, the propagation
+ * stops there. Planes that were not needed are computed when requested
+ * by getplane() in that case, getexit() tells which plane the result 
+ * came from.
+ *
+ * If a result cache is set (see setcache()), repeated inputs are 
+ * answered from the cache, planes are then computed by getplane() too.
  * \param  input pointer to input image in CvMat or IplImage format
- * \return (0,0) value of the last plane
+ * \return (0,0) value of the last plane (or of the confident exit plane)
  */
 double CvConvNet::fprop (CvArr * input )
+{
+	m_exitidx = -1;
+	if ( !setinput(input) )
+		return -1.0;
+
+	return propagate();
+}
+
+/*! The method samples the region of the frame into the source plane
+ * and propagates it like fprop(CvArr*) does. Grey conversion, scaling
+ * to the size of the source plane and preprocessing are done in one pass
+ * straight from the frame, there are no temporary images.
+ * \param  frame pointer to the frame in CvMat or IplImage format
+ * \param  roi region of the frame to be propagated
+ * \param  interp interpolation: CV_INTER_NN or CV_INTER_LINEAR
+ * \return (0,0) value of the last plane (or of the confident exit plane)
+ */
+double CvConvNet::fprop (CvArr * frame, CvRect roi, int interp )
+{
+	m_exitidx = -1;
+	if ( !setinput(frame, roi, interp) )
+		return -1.0;
+
+	return propagate();
+}
+
+/*! The method does the work of fprop() after the input is set.
+ * \return (0,0) value of the last plane (or of the confident exit plane)
+ */
+double CvConvNet::propagate( )
+{
+	uint64 key = 0;
+	double result;
+	if (m_cache != NULL)
+	{
+		key = CvResultCache::hash(m_plane[0]->getfmap());
+		if (m_cache->lookup(key, m_plane[0]->getfmap(), result, m_exitidx))
+			return result;
+	}
+	
+	for (int i = 0; i < m_exit.size(); i++)
+	{
+		int idx = m_idmap[m_exit[i].first];
+
+		evalplane(idx);
+		if (m_plane[idx]->getconfidence() >= m_exit[i].second)
+		{
+			m_exitidx = idx;
+			break;
+		}
+	}
+
+	if (m_exitidx < 0)
+	{
+		// Iterate over all planes
+		for (signed int i = 0; i < m_plane.size(); i++)
+		{
+			/*! \todo implement parallel fprop() invocation
+			 * since independent planes can execute fprop 
+			 * simultaneously!
+			 */
+			evalplane(i);
+		}
+		m_exitidx = m_plane.size()-1;
+	}
+
+	result = cvmGet(m_plane[m_exitidx]->getfmap(),0,0);
+	if (m_cache != NULL)
+		m_cache->store(key, m_plane[0]->getfmap(), result, m_exitidx);
+
+	return result;
+}
+
+/*! The method propagates the input image through the network
+ * recomputing only the parts of feature maps that depend on the changed
+ * regions of the input. The rest of every feature map is kept from
+ * the previous fprop, so the caller must guarantee that the image 
+ * is the same as the previous one outside the given regions.
+ * If the network does not hold a complete result for the previous
+ * input (first call, early exit, partial eval()), the whole network 
+ * is propagated. Exit points are not checked.
+ * \param  input pointer to input image in CvMat or IplImage format
+ * \param  dirty changed regions of the input image
+ * \return (0,0) value of the last plane
+ */
+double CvConvNet::fprop (CvArr * input, const std::vector<CvRect> &dirty )
+{
+	if ( !isvalid() )
+		return fprop(input);
+
+	m_exitidx = -1;
+	if ( (input == NULL) || !(m_plane[0]->setfmap(input)) )
+	{
+		cerr << "ERROR: Wrong input image" << endl;
+		return -1.0;
+	}
+
+	// Input image regions are not necessarily at the same place in the feature map
+	vector<CvRect> region;
+	for (int i = 0; i < dirty.size(); i++)
+	{
+		region.push_back(m_plane[0]->getdirtyrect(dirty[i]));
+	}
+
+	fpropdirty(region);
+
+	m_exitidx = m_plane.size()-1;
+	return cvmGet(m_plane.back()->getfmap(),0,0);
+}
+
+/*! The method finds the region where the input image differs from
+ * the previous one and propagates only this region (see 
+ * fprop(CvArr*, const std::vector<CvRect>&)). It suits video streams
+ * where consecutive frames differ only in small regions.
+ * 
+ * Pixels that differ by no more than tolerance are considered
+ * unchanged and keep their previous values in the source plane, so that
+ * the result never drifts from the propagated image by more than 
+ * the tolerance. Zero tolerance gives exactly the result of fprop().
+ * \param  input pointer to input image in CvMat or IplImage format
+ * \param  tolerance maximum difference of pixel values considered as noise
+ * \return (0,0) value of the last plane
+ */
+double CvConvNet::fpropincr (CvArr * input, double tolerance )
+{
+	if ( !isvalid() )
+		return fprop(input);
+
+	CvMat *src = m_plane[0]->getfmap();
+	CvMat *prev = cvCloneMat(src);
+
+	m_exitidx = -1;
+	if ( (input == NULL) || !(m_plane[0]->setfmap(input)) )
+	{
+		cerr << "ERROR: Wrong input image" << endl;
+		cvReleaseMat(&prev);
+		return -1.0;
+	}
+
+	// Bounding box of changed pixels
+	int x0 = src->cols, y0 = src->rows, x1 = 0, y1 = 0;
+	for (int y = 0; y < src->rows; y++)
+	{
+		const double *cur = (const double *)(src->data.ptr + (size_t)src->step*y);
+		const double *old = (const double *)(prev->data.ptr + (size_t)prev->step*y);
+
+		for (int x = 0; x < src->cols; x++)
+		{
+			if (fabs(cur[x]-old[x]) > tolerance)
+			{
+				x0 = MIN(x0, x); x1 = MAX(x1, x+1);
+				y0 = MIN(y0, y); y1 = MAX(y1, y+1);
+			}
+		}
+	}
+
+	vector<CvRect> dirty;
+	if (x1 > x0)
+	{
+		dirty.push_back(cvRect(x0, y0, x1-x0, y1-y0));
+	}
+
+	// Keep previous values outside of the changed region
+	if (tolerance > 0.0)
+	{
+		CvMat region, pregion;
+		CvMat *cur = cvCloneMat(src);
+		cvCopy(prev, src);
+		for (int i = 0; i < dirty.size(); i++)
+		{
+			cvGetSubRect(cur, &pregion, dirty[i]);
+			cvGetSubRect(src, &region, dirty[i]);
+			cvCopy(&pregion, &region);
+		}
+		cvReleaseMat(&cur);
+	}
+	cvReleaseMat(&prev);
+
+	fpropdirty(dirty);
+
+	m_exitidx = m_plane.size()-1;
+	return cvmGet(m_plane.back()->getfmap(),0,0);
+}
+
+/*! Dirty regions of every plane are collected from dirty regions of
+ * its parents, overlapping regions are merged, and only these regions
+ * are recomputed.
+ * \param dirty changed regions of the source plane's feature map
+ */
+void CvConvNet::fpropdirty( const std::vector<CvRect> &dirty )
+{
+	vector< vector<CvRect> > region(m_plane.size());
+	CvMat *src = m_plane[0]->getfmap();
+
+	for (int i = 0; i < dirty.size(); i++)
+	{
+		int x0 = MAX(dirty[i].x, 0), y0 = MAX(dirty[i].y, 0);
+		int x1 = MIN(dirty[i].x+dirty[i].width, src->cols);
+		int y1 = MIN(dirty[i].y+dirty[i].height, src->rows);
+
+		if (x1 > x0 && y1 > y0)
+			icvAddRect(region[0], cvRect(x0, y0, x1-x0, y1-y0));
+	}
+
+	for (int i = 1; i < m_plane.size(); i++)
+	{
+		// The leader of a group recomputes regions of all planes of the group
+		for (int g = 0; g < m_member[i].size(); g++)
+		{
+			const vector<int> &parent = m_parent[m_member[i][g]];
+			for (int j = 0; j < parent.size(); j++)
+			{
+				const vector<CvRect> &pregion = region[parent[j]];
+
+				for (int k = 0; k < pregion.size(); k++)
+				{
+					CvRect r = m_plane[i]->getdirtyrect(pregion[k]);
+					if (r.width > 0 && r.height > 0)
+						icvAddRect(region[i], r);
+				}
+			}
+		}
+
+		for (int k = 0; k < region[i].size(); k++)
+		{
+			m_plane[i]->fpropregion(region[i][k]);
+		}
+	}
+}
+
+/*!
+ * \return 1 if every plane is computed for the current input, 0 otherwise
+ */
+int CvConvNet::isvalid( )
+{
+	if (m_plane.empty() || m_valid.size() != m_plane.size())
+		return 0;
+
+	for (int i = 0; i < m_valid.size(); i++)
+	{
+		if (!m_valid[i])
+			return 0;
+	}
+	return 1;
+}
+
+/*! With a cache set, fprop first looks up the source plane (by its hash,
+ * verified against the stored copy) and returns the cached result 
+ * without evaluating any plane if found.
+ * Feature maps of other planes are not computed in that case, they
+ * are computed when requested by getplane() or eval(). The cache is
+ * not owned by the network and may be shared by several networks loaded
+ * from the same model.
+ * \param cache result cache or NULL to disable caching
+ */
+void CvConvNet::setcache ( CvResultCache *cache )
+{
+	m_cache = cache;
+}
+
+/*!
+ * \return id of the plane whose value was returned by the last fprop
+ * or empty string if there was no successful fprop
+ */
+std::string CvConvNet::getexit ( )
+{
+	if (m_exitidx < 0)
+		return "";
+
+	return m_plane[m_exitidx]->getid();
+}
+
+/*! The method copies the input image into the source plane and
+ * marks all other planes as not computed. Nothing is propagated
+ * until some plane is requested by eval().
+ * \param  input pointer to input image in CvMat or IplImage format
+ * \return status of operation
+ */
+int CvConvNet::setinput (CvArr * input )
 {
 	if ( (input == NULL) || !(m_plane[0]->setfmap(input)) )
 	{
@@ -92,20 +414,293 @@ double CvConvNet::fprop (CvArr * input )
 		 * instead of printing to cerr 
                  */
 		cerr << "ERROR: Wrong input image" << endl;
-		return -1.0;
+		return 0;
 	}
-	
-	// Iterate over all planes
-	for (signed int i = 0; i < m_plane.size(); i++)
+
+	m_valid.assign(m_plane.size(), 0);
+	m_valid[0] = 1;
+	return 1;
+}
+
+/*! The method samples a region of the frame into the source plane
+ * (see CvSourcePlane::setfmap()) and marks all other planes 
+ * as not computed.
+ * \param  frame pointer to the frame in CvMat or IplImage format
+ * \param  roi region of the frame to be propagated
+ * \param  interp interpolation: CV_INTER_NN or CV_INTER_LINEAR
+ * \return status of operation
+ */
+int CvConvNet::setinput (CvArr * frame, CvRect roi, int interp )
+{
+	CvSourcePlane *source = dynamic_cast<CvSourcePlane *>(m_plane[0]);
+
+	if ( (source == NULL) || !(source->setfmap(frame, roi, interp)) )
 	{
-		/*! \todo implement parallel fprop() invocation
-		 * since independent planes can execute fprop 
-		 * simultaneously!
-		 */
-		m_plane[i]->fprop();
+		cerr << "ERROR: Wrong input frame or region" << endl;
+		return 0;
 	}
 
-	return cvmGet(m_plane.back()->getfmap(),0,0);
+	m_valid.assign(m_plane.size(), 0);
+	m_valid[0] = 1;
+	return 1;
+}
+
+/*! The method computes the feature map of the given plane for
+ * the input set by setinput(). Only the ancestors of the plane are
+ * evaluated and planes already computed for the same input are reused,
+ * so heads of the network sharing the trunk can be requested one by one.
+ * \param id String specifying the plane
+ * \return pointer to the feature map or NULL if there is no such plane
+ */
+const CvMat *CvConvNet::eval( std::string id )
+{
+	map<string,int>::iterator itr = m_idmap.find(id); 
+	if (itr == m_idmap.end())
+		return NULL;
+
+	evalplane(itr->second);
+	return m_plane[itr->second]->getfmap();
+}
+
+/*! The first id is the source plane, the last one is the plane 
+ * whose value fprop() returns (unless an exit point is taken).
+ * \return vector of plane ids
+ */
+std::vector<std::string> CvConvNet::getids( )
+{
+	vector<string> ids;
+	for (int i = 0; i < m_plane.size(); i++)
+		ids.push_back(m_plane[i]->getid());
+
+	return ids;
+}
+
+/*! Images of this size are taken by fprop() and setinput(),
+ * regions passed with a frame are scaled to it.
+ * \return size of input images or 0x0 if the network is empty
+ */
+CvSize CvConvNet::getinputsz( )
+{
+	CvSourcePlane *source = m_plane.empty() ? NULL : dynamic_cast<CvSourcePlane *>(m_plane[0]);
+	if (source == NULL)
+		return cvSize(0,0);
+
+	return source->getinputsz();
+}
+
+/*! Networks whose source plane declares neither mean nor scale
+ * take input pixels as they are (mean 0, scale 1).
+ * \param mean value subtracted from input pixels
+ * \param scale factor applied after the subtraction
+ * \return status of operation
+ */
+int CvConvNet::getnormalization( double &mean, double &scale )
+{
+	CvSourcePlane *source = m_plane.empty() ? NULL : dynamic_cast<CvSourcePlane *>(m_plane[0]);
+	if (source == NULL)
+		return 0;
+
+	source->getnormalization(mean, scale);
+	return 1;
+}
+
+/*! The method computes the feature maps of several planes 
+ * for the input set by setinput(). Results are then accessed by getplane().
+ * \param ids String ids of the planes
+ * \return status of operation
+ */
+int CvConvNet::eval( const std::vector<std::string> &ids )
+{
+	for (int i = 0; i < ids.size(); i++)
+	{
+		if (eval(ids[i]) == NULL)
+			return 0;
+	}
+	return 1;
+}
+
+/*! Planes are stored in topological order, so ancestors are
+ * collected by one backward pass and then evaluated by one forward pass.
+ * \param idx index of the plane
+ */
+void CvConvNet::evalplane( int idx )
+{
+	assert( idx >= 0 && idx < m_plane.size() );
+	assert( m_valid.size() == m_plane.size() );
+
+	if (m_valid[idx])
+		return;
+
+	vector<int> need(idx+1, 0);
+	need[idx] = 1;
+	for (int i = idx; i > 0; i--)
+	{
+		if (!need[i] || m_valid[i])
+			continue;
+
+		for (int g = 0; g < m_member[i].size(); g++)
+			for (int j = 0; j < m_parent[m_member[i][g]].size(); j++)
+				need[m_parent[m_member[i][g]][j]] = 1;
+		need[m_leader[i]] = 1;
+	}
+
+	for (int i = 0; i <= idx; i++)
+	{
+		if (need[i] && !m_valid[i])
+		{
+			m_plane[i]->fprop();
+			m_valid[i] = 1;
+		}
+	}
+}
+
+/*! The method translates parent links of every plane into indices
+ * of parent planes. Parser guarantees that parents come first.
+ * It also groups convolutional, output RBF, regression and pointwise planes
+ * sharing their parents (see CvConvolutionPlane::share(), CvRBFPlane::share(),
+ * CvRegressionPlane::share() and CvPointwisePlane::share()). Lazy evaluation computes the leader of a group
+ * whenever another plane of the group is needed, and the leader's region of
+ * incremental evaluation covers the regions of all planes of the group.
+ * \return status of operation
+ */
+int CvConvNet::link( )
+{
+	m_parent.assign(m_plane.size(), vector<int> ());
+	m_leader.resize(m_plane.size());
+	m_member.resize(m_plane.size());
+	m_valid.assign(m_plane.size(), 0);
+
+	for (int i = 0; i < m_plane.size(); i++)
+	{
+		m_leader[i] = i;
+		m_member[i].assign(1, i);
+		const vector<CvGenericPlane *> &pplane = m_plane[i]->getparents();
+
+		for (int j = 0; j < pplane.size(); j++)
+		{
+			map<string,int>::iterator itr = m_idmap.find(pplane[j]->getid()); 
+			if (itr == m_idmap.end() || itr->second >= i)
+			{
+				cerr << "ERROR: Plane " << m_plane[i]->getid() << " is not linked properly" << endl;
+				return 0;
+			}
+			m_parent[i].push_back(itr->second);
+		}
+	}
+
+	// Convolutional banks, output RBF planes, regression planes and
+	// pointwise planes with the same parents are computed together. The leader is the first plane
+	// of the group, the others depend on it.
+	sharebanks();
+	share<CvRBFPlane>();
+	share<CvRegressionPlane>();
+	share<CvPointwisePlane>();
+
+	return 1;
+}
+
+/*! Planes of type T are grouped by their parents, neuron window and 
+ * feature map size, and the first plane of every group of two or more planes
+ * is asked to compute the whole group by T::share().
+ */
+template <class T>
+void CvConvNet::share( )
+{
+	map< vector<int>, vector<int> > groups;
+	for (int i = 0; i < m_plane.size(); i++)
+	{
+		T *plane = dynamic_cast<T *>(m_plane[i]);
+		if (plane == NULL)
+			continue;
+
+		vector<int> key = m_parent[i];
+		key.push_back(plane->getneurosz().width);
+		key.push_back(plane->getneurosz().height);
+		key.push_back(plane->getfmap()->cols);
+		key.push_back(plane->getfmap()->rows);
+		groups[key].push_back(i);
+	}
+
+	for (map< vector<int>, vector<int> >::iterator itr = groups.begin(); itr != groups.end(); itr++)
+	{
+		const vector<int> &idx = itr->second;
+		if (idx.size() < 2)
+			continue;
+
+		vector<T *> group;
+		for (int j = 0; j < idx.size(); j++)
+			group.push_back(dynamic_cast<T *>(m_plane[idx[j]]));
+
+		if (group[0]->share(group))
+			addgroup(idx);
+	}
+}
+
+/*! Convolutional planes of the same type and shape are candidates for
+ * a bank regardless of their parents, so planes of a layer with a sparse
+ * connection table are computed together (see CvConvolutionPlane::share()).
+ * Parents of every plane of a bank must be computed before its leader,
+ * planes that don't satisfy this go to the next bank.
+ */
+void CvConvNet::sharebanks( )
+{
+	map< pair<string, vector<int> >, vector<int> > candidates;
+	for (int i = 0; i < m_plane.size(); i++)
+	{
+		CvConvolutionPlane *plane = dynamic_cast<CvConvolutionPlane *>(m_plane[i]);
+		if (plane == NULL)
+			continue;
+
+		vector<int> shape;
+		shape.push_back(plane->getneurosz().width);
+		shape.push_back(plane->getneurosz().height);
+		shape.push_back(plane->getfmap()->cols);
+		shape.push_back(plane->getfmap()->rows);
+		shape.push_back(plane->getstride().width);
+		shape.push_back(plane->getstride().height);
+		shape.push_back(plane->getpadding().width);
+		shape.push_back(plane->getpadding().height);
+		candidates[make_pair(plane->gettype(), shape)].push_back(i);
+	}
+
+	for (map< pair<string, vector<int> >, vector<int> >::iterator itr = candidates.begin(); itr != candidates.end(); itr++)
+	{
+		vector<int> rest = itr->second;
+		while (rest.size() > 1)
+		{
+			vector<int> idx, next;
+			for (int j = 0; j < rest.size(); j++)
+			{
+				const vector<int> &parent = m_parent[rest[j]];
+				if (j == 0 || parent.empty() || *max_element(parent.begin(), parent.end()) < rest[0])
+					idx.push_back(rest[j]);
+				else
+					next.push_back(rest[j]);
+			}
+			rest = next;
+
+			if (idx.size() < 2)
+				continue;
+
+			vector<CvConvolutionPlane *> group;
+			for (int j = 0; j < idx.size(); j++)
+				group.push_back(dynamic_cast<CvConvolutionPlane *>(m_plane[idx[j]]));
+
+			if (group[0]->share(group))
+				addgroup(idx);
+		}
+	}
+}
+
+/*! Other planes of the group depend on the first one, which reads
+ * parents of all planes of the group.
+ * \param idx indices of planes of the group, the leader first
+ */
+void CvConvNet::addgroup( const vector<int> &idx )
+{
+	m_member[idx[0]] = idx;
+	for (int j = 1; j < idx.size(); j++)
+		m_leader[idx[j]] = idx[0];
 }
 
 
@@ -113,6 +708,8 @@ double CvConvNet::fprop (CvArr * input )
  * of any individual feature map inside the network
  * The plane is specified by its text id (it is the same id
  * that is assigned to plane in XML file).
+ * A plane not computed for the current input, because fprop() took
+ * an exit point or a cached result, is computed first (see eval()).
  * \param id String specifying the feature map to be accessed
  * \return pointer to CvMat structure of the specified plane
  */
@@ -121,9 +718,192 @@ const CvMat *CvConvNet::getplane( std::string id )
 	map<string,int>::iterator itr = m_idmap.find(id); 
 	assert( itr != m_idmap.end() );
 
+	evalplane(itr->second);
 	return m_plane[itr->second]->getfmap();
 }
 
+/*! The method makes all planes of the network use the given backend
+ * for their computations.
+ * \param backend name of the backend (see cvGetBackend())
+ * \return status of operation
+ */
+int CvConvNet::setbackend( std::string backend )
+{
+	CvBackend *b = cvGetBackend(backend);
+	if (b == NULL)
+		return 0;
+
+	for (int i = 0; i < m_plane.size(); i++)
+	{
+		m_plane[i]->setbackend(b);
+	}
+	return 1;
+}
+
+/*! The method makes an individual plane use the given backend.
+ * \param id String specifying the plane
+ * \param backend name of the backend (see cvGetBackend())
+ * \return status of operation
+ */
+int CvConvNet::setbackend( std::string id, std::string backend )
+{
+	map<string,int>::iterator itr = m_idmap.find(id); 
+	if (itr == m_idmap.end())
+		return 0;
+
+	return m_plane[itr->second]->setbackend(cvGetBackend(backend));
+}
+
+/*! The method times all backends on every plane of the network and 
+ * makes each plane use the fastest one, convolutional planes with several
+ * parents also get the faster layout of parents (see 
+ * CvConvolutionPlane::setlayout()). The choice depends on
+ * plane's shapes and on the CPU, so it is stored in the tuning cache file
+ * and the next process running on the same CPU just reads it from there.
+ * Planes are timed on a synthetic input, so feature maps of all planes
+ * (the source plane included) are overwritten during tuning.
+ * \param cachefile name of the tuning cache file (empty for no cache)
+ * \return status of operation
+ */
+int CvConvNet::tune( std::string cachefile )
+{
+	// Tuning overwrites feature maps
+	m_valid.assign(m_plane.size(), 0);
+	if (!m_valid.empty())
+		m_valid[0] = 1;
+
+	return ::tune(m_plane, m_leader, cachefile);
+}
+
+/*! Weights of weighted sums (not biases) whose magnitude is below
+ * the threshold are set to zero (see CvGenericPlane::prune()), planes
+ * compute pruned kernels by sparse kernels. Results of previous inputs
+ * are not valid any more, so the next fprop computes every plane
+ * and a result cache set by setcache() is cleared.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvConvNet::prune( double threshold )
+{
+	int pruned = 0;
+	for (int i = 0; i < m_plane.size(); i++)
+		pruned += m_plane[i]->prune(threshold);
+
+	m_valid.assign(m_plane.size(), 0);
+	if (m_cache != NULL && pruned > 0)
+		m_cache->clear();
+	return pruned;
+}
+
+/*! Kernels of convolutional planes are replaced by the sum of fewest
+ * rank one terms of their singular value decomposition within the 
+ * tolerance (see CvConvolutionPlane::approximate()), the planes 
+ * compute them as a row and a column pass per term. 
+ * The approximated kernels are written by toString() as ordinary kernels,
+ * so the network loaded from the XML computes them in the same way.
+ * Results of previous inputs are not valid any more, a result cache set
+ * by setcache() is cleared.
+ * \param tolerance relative error of a kernel in Frobenius norm
+ * \return number of kernels replaced
+ */
+int CvConvNet::approximate( double tolerance )
+{
+	int replaced = 0;
+	for (int i = 0; i < m_plane.size(); i++)
+		replaced += m_plane[i]->approximate(tolerance);
+
+	m_valid.assign(m_plane.size(), 0);
+	if (m_cache != NULL && replaced > 0)
+		m_cache->clear();
+	return replaced;
+}
+
+/*! Children of the plane lose the connection to it together with its
+ * weights, which has the same effect on them as a feature map of zeros.
+ * Children left without any parent (e.g. the subsampling plane of a removed
+ * convolutional plane) are removed as well, and so on. 
+ * The source plane, the last plane and the parents of a max plane 
+ * can't be removed. 
+ *
+ * The network is reloaded from its modified XML representation, so 
+ * backends selected for individual planes are reset and planes are grouped 
+ * again. Exit points at removed planes are dropped and a result cache 
+ * set by setcache() is cleared.
+ * \param id string id of the plane
+ * \return number of removed planes, 0 if the plane can't be removed
+ */
+int CvConvNet::removeplane( std::string id )
+{
+	map<string,int>::iterator itr = m_idmap.find(id);
+	if (itr == m_idmap.end() || itr->second == 0)
+		return 0;
+
+	// Parents precede their children, so one pass finds all removed planes
+	vector<int> removed(m_plane.size(), 0);
+	removed[itr->second] = 1;
+	int count = 1;
+	for (int i = itr->second+1; i < m_plane.size(); i++)
+	{
+		int left = 0;
+		for (int j = 0; j < m_parent[i].size(); j++)
+			left += !removed[m_parent[i][j]];
+		if (left == 0)
+		{
+			removed[i] = 1;
+			count++;
+		}
+	}
+	if (removed.back())
+		return 0;
+
+	// The planes are modified in place, the original is restored on failure
+	string original = toString();
+	int status = 1;
+	for (int i = 0; i < m_plane.size() && status; i++)
+	{
+		if (removed[i])
+			continue;
+		for (int j = m_parent[i].size()-1; j >= 0 && status; j--)
+		{
+			if (removed[m_parent[i][j]])
+				status = m_plane[i]->removeparent(j);
+		}
+	}
+
+	string xml = original;
+	if (status)
+	{
+		vector<CvGenericPlane *> plane;
+		for (int i = 0; i < m_plane.size(); i++)
+		{
+			if (removed[i])
+				delete m_plane[i];
+			else
+				plane.push_back(m_plane[i]);
+		}
+		m_plane = plane;
+
+		vector< pair<string,double> > exit;
+		for (int i = 0; i < m_exit.size(); i++)
+		{
+			if (!removed[m_idmap[m_exit[i].first]])
+				exit.push_back(m_exit[i]);
+		}
+		m_exit = exit;
+
+		xml = toString();
+		if (m_cache != NULL)
+			m_cache->clear();
+	}
+
+	// Parser releases the remaining planes
+	m_exitidx = -1;
+	if (!fromString(xml))
+		return 0;
+
+	return status ? count : 0;
+}
+
 /*! Method produces an XML representation of the complete structure of
  * the convolutional network including information about connections 
  * between planes, weights for specific connections.
@@ -145,19 +925,40 @@ std::string CvConvNet::toString()
  */
 int CvConvNet::fromString ( std::string xml )
 {
-	return parse(xml, m_creator, m_name, m_info, m_plane, m_idmap);
+	if (!parse(xml, m_creator, m_name, m_info, m_plane, m_idmap, m_exit))
+		return 0;
+
+	return link();
+}
+
+/*! The method generates C++ source code of the network with the
+ * weights and all feature map sizes compiled in.
+ * The code needs neither this library nor OpenCV to be built.
+ * \param funcname name of the forward propagation function to generate
+ * \param code string receiving generated source
+ * \return status of operation
+ */
+int CvConvNet::toCode ( std::string funcname, std::string &code )
+{
+	return generate(funcname, m_name, m_plane, code);
 }
 
 
 ostream& operator<< (ostream& s, CvConvNet& n)
 {
 	s << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
-	s << "<net name=\"" << n.m_name << "\" creator=\"" << n.m_creator << "\"" << endl;
+	s << "<net name=\"" << n.m_name << "\" creator=\"" << n.m_creator << "\">" << endl;
 	s << "\t<info> " << n.m_info << " </info>" << endl;
 	for (signed int i=0; i < n.m_plane.size(); i++)
 	{
 		s << n.m_plane[i]->toString();
 	}
+	streamsize precision = s.precision(CVCONVNET_XML_PRECISION);
+	for (signed int i=0; i < n.m_exit.size(); i++)
+	{
+		s << "\t<exit plane=\"" << n.m_exit[i].first << "\" threshold=\"" << n.m_exit[i].second << "\"/>" << endl;
+	}
+	s.precision(precision);
 	s << "</net>" << endl;
 	return s;
 }
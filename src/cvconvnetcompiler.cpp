@@ -0,0 +1,197 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Code generator implementation
+ *
+ * The file contains a generator that turns a loaded convolutional
+ * network into a self-contained C++ source file.
+ * The generated file has a state structure holding all feature maps,
+ * static arrays with the weights of every plane and one forward 
+ * propagation function whose loop bounds are all constants.
+ * It depends on nothing but the standard math library, so it can be built
+ * into applications that have neither OpenCV nor Expat.
+ * \date 2026
+ */
+
+#include <cassert>
+#include <cctype>
+#include <vector>
+#include <set>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include "cvconvnetcompiler.h"
+#include "cvgenericplane.h"
+
+using namespace std;
+
+//! Fast sigmoid approximation as emitted into generated code (see cvfastsigmoid.cpp)
+static const char *icvStdSigmoidCode =
+	"static double stdsigmoid(double x)\n"
+	"{\n"
+	"\tconst double PR = 0.66666666;\n"
+	"\tconst double PO = 1.71593428;\n"
+	"\tconst double A0 = 1.0;\n"
+	"\tconst double A1 = 0.125*PR;\n"
+	"\tconst double A2 = 0.0078125*PR*PR;\n"
+	"\tconst double A3 = 0.000325520833333*PR*PR*PR;\n"
+	"\tdouble y;\n"
+	"\n"
+	"\tif (x >= 0.0)\n"
+	"\t\tif (x < 13.0)\n"
+	"\t\t\ty = A0+x*(A1+x*(A2+x*(A3)));\n"
+	"\t\telse\n"
+	"\t\t\treturn PO;\n"
+	"\telse\n"
+	"\t\tif (x > -13.0)\n"
+	"\t\t\ty = A0-x*(A1-x*(A2-x*(A3)));\n"
+	"\t\telse\n"
+	"\t\t\treturn -PO;\n"
+	"\n"
+	"\ty *= y;\n"
+	"\ty *= y;\n"
+	"\ty *= y;\n"
+	"\ty *= y;\n"
+	"\n"
+	"\treturn (x > 0.0) ? PO*(y-1.0)/(y+1.0) : PO*(1.0-y)/(y+1.0);\n"
+	"}\n";
+
+//! Checks whether the string is a valid C identifier
+static int icvIsIdentifier(string name)
+{
+	if (name.size() == 0 || isdigit((unsigned char) name[0]))
+		return 0;
+	for (int i=0; i<name.size(); i++)
+	{
+		if (!isalnum((unsigned char) name[i]) && name[i] != '_')
+			return 0;
+	}
+	return 1;
+}
+
+/*! The function generates C++ source of the network.
+ * The generated function has the following prototype:
+ * double funcname(struct funcname_state *s, const double *input);
+ * where input is a row-major source image and the return value is
+ * the (0,0) value of the last plane, exactly as CvConvNet::fprop() does.
+ * \param funcname name of the generated function
+ * \param netname name of the network (used in comments only)
+ * \param plane topologically sorted planes of the network
+ * \param code generated source
+ * \return status of operation
+ */
+int generate(string funcname, string netname,
+		vector<CvGenericPlane *> &plane,
+		string &code)
+{
+	if (plane.size() == 0)
+	{
+		cerr << "ERROR: Can't generate code for an empty network" << endl;
+		return 0;
+	}
+	if (!icvIsIdentifier(funcname))
+	{
+		cerr << "ERROR: \"" << funcname << "\" is not a valid function name" << endl;
+		return 0;
+	}
+
+	// Plane symbols are derived from ids, so make sure they don't collide
+	set<string> symbols;
+	for (int i=0; i<plane.size(); i++)
+	{
+		if (!symbols.insert(plane[i]->getsymbol()).second)
+		{
+			cerr << "ERROR: Plane \"" << plane[i]->getid() << "\" maps into an already used symbol " << plane[i]->getsymbol() << endl;
+			return 0;
+		}
+	}
+
+	ostringstream src;
+	src.precision(numeric_limits<double>::digits10 + 2);
+
+	src << "/* Generated by cvconvnet-compile from network \"" << netname << "\". Do not edit. */" << endl;
+	src << endl;
+	src << "#include <math.h>" << endl;
+	src << "#include <float.h>" << endl;
+	src << endl;
+
+	// State structure holds all the feature maps
+	src << "struct " << funcname << "_state" << endl;
+	src << "{" << endl;
+	for (int i=0; i<plane.size(); i++)
+	{
+		CvMat *fmap = plane[i]->getfmap();
+		src << "\tdouble " << plane[i]->getsymbol() << "[" << fmap->rows << "][" << fmap->cols << "];" << endl;
+	}
+	src << "};" << endl;
+	src << endl;
+
+	src << icvStdSigmoidCode << endl;
+
+	// Weights of every plane are compiled in as constants
+	for (int i=0; i<plane.size(); i++)
+	{
+		const vector<double> &weight = plane[i]->getweight();
+		if (weight.size() == 0)
+			continue;
+
+		src << "static const double " << plane[i]->getsymbol() << "_w[" << weight.size() << "] =" << endl;
+		src << "{";
+		for (int j=0; j<weight.size(); j++)
+		{
+			src << ((j % 8) ? " " : "\n\t") << weight[j] << ((j+1 < weight.size()) ? "," : "");
+		}
+		src << endl << "};" << endl;
+		src << endl;
+	}
+
+	// The forward propagation itself
+	src << "/* Forward propagation; input is a row-major image (see " << plane[0]->getid() << " below) */" << endl;
+	src << "double " << funcname << "(struct " << funcname << "_state *s, const double *input)" << endl;
+	src << "{" << endl;
+	src << "\tint x, y, j, k;" << endl;
+	src << "\tdouble sum;" << endl;
+	src << endl;
+	for (int i=0; i<plane.size(); i++)
+	{
+		src << plane[i]->toCode() << endl;
+	}
+	src << "\treturn s->" << plane.back()->getsymbol() << "[0][0];" << endl;
+	src << "}" << endl;
+
+	code = src.str();
+	return 1;
+}
@@ -58,11 +58,14 @@ preliminary and subject to change at any time, without notice.
 #include <sstream>
 #include "cvconvnetparser.h"
 #include "cvconvolutionplane.h"
+#include "cvdepthwiseplane.h"
+#include "cvpointwiseplane.h"
 #include "cvgenericplane.h"
 #include "cvmaxplane.h"
 #include "cvmaxoperatorplane.h"
 #include "cvrbfplane.h"
 #include "cvregressionplane.h"
+#include "cvdenseplane.h"
 #include "cvsourceplane.h"
 #include "cvsubsamplingplane.h"
 
@@ -93,6 +96,7 @@ typedef struct
  	// Graph parameters
 	vector<CvGenericPlane *> &plane; //!< Container for all planes
 	map<string,int> &idmap; //!< Mapping between ids
+	vector< pair<string,double> > &exits; //!< Early exit planes and thresholds
 
 	// Current (recursive) parameters
 	int depth;			//!< Current depth of XML recursion
@@ -142,6 +146,7 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 		data.creator.clear();
 		data.name.clear();
 		data.idmap.clear();
+		data.exits.clear();
 		data.isbias = 0;
 		data.isinfo = 0;
 
@@ -162,6 +167,11 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 		int curplaneid = data.plane.size(); // Planeid that is going to be assigned for this plane
 		string planeid,planetype; // Plane info as read from the files
 		int fmapszx = 0, fmapszy = 0, neuroszx = 0, neuroszy = 0;
+		int stridex = 1, stridey = 1; // Stride of convolution planes
+		int paddingx = 0, paddingy = 0; // Padding of source and convolution planes
+		double mean = 0.0, scale = 1.0;
+		string inputtype = "any";
+		string select = "max"; // Max planes may search for minimum
 
 		// Initialize data structures
 		data.cur_parents.clear();
@@ -187,6 +197,36 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 				char c;
 				iss >> neuroszx >> c >> neuroszy;
 			}
+			if (attr=="stride")
+			{
+				// Either "WxH" or a single number for both directions
+				istringstream iss ( val );
+				char c;
+				iss >> stridex;
+				if (!(iss >> c >> stridey))
+					stridey = stridex;
+			}
+			if (attr=="padding")
+			{
+				// Either "WxH" or a single number for both directions
+				istringstream iss ( val );
+				char c;
+				iss >> paddingx;
+				if (!(iss >> c >> paddingy))
+					paddingy = paddingx;
+			}
+			if (attr=="mean")
+			{
+				istringstream iss ( val );
+				iss >> mean;
+			}
+			if (attr=="scale")
+			{
+				istringstream iss ( val );
+				iss >> scale;
+			}
+			if (attr=="inputtype") inputtype = val;
+			if (attr=="select") select = val;
 		}
 		// Plane MUST have an id
 		CHK_POSSIBLE_FAIL( planeid.size()==0 , "plane has no id");
@@ -196,7 +236,7 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 		{
 			CHK_POSSIBLE_FAIL( (fmapszx <= 0 || fmapszy <= 0 || fmapszx > CVCONVOLUTIONALNET_MAX_FMAPSZ || fmapszy > CVCONVOLUTIONALNET_MAX_FMAPSZ) ,"feature map size is inconsistent");
                 }
-                if (planetype != "max")
+                if (planetype != "max" && planetype != "pointwise")
                 {
 	
 			CHK_POSSIBLE_FAIL( (neuroszx < 0 || neuroszy < 0 || neuroszx > CVCONVOLUTIONALNET_MAX_FMAPSZ || neuroszy > CVCONVOLUTIONALNET_MAX_FMAPSZ), "neuron window size is inconsistent");
@@ -205,14 +245,28 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 		// Create required plane object with inited parameters 
 		if (planetype=="source")
 		{
-			data.plane.push_back( 
-				new CvSourcePlane(planeid,cvSize(fmapszx,fmapszy)) 
-			);
+			CvSourcePlane *source = new CvSourcePlane(planeid,cvSize(fmapszx,fmapszy));
+			data.plane.push_back( source );
+			data.idmap[planeid] = curplaneid;
+
+			CHK_POSSIBLE_FAIL( paddingx != paddingy || !source->setpreprocessing(paddingx,mean,scale,inputtype), "source plane "+planeid+" has inconsistent padding or unknown input type");
+		} else if (planetype=="convolution" || planetype=="depthwise")
+		{
+			CHK_POSSIBLE_FAIL( (stridex <= 0 || stridey <= 0 || stridex > CVCONVOLUTIONALNET_MAX_FMAPSZ || stridey > CVCONVOLUTIONALNET_MAX_FMAPSZ), "stride of plane "+planeid+" is inconsistent");
+			CHK_POSSIBLE_FAIL( (paddingx < 0 || paddingy < 0 || paddingx >= neuroszx || paddingy >= neuroszy), "padding of plane "+planeid+" must be less than neuron window");
+			if (planetype=="convolution")
+				data.plane.push_back(
+					new CvConvolutionPlane(planeid,cvSize(fmapszx,fmapszy),cvSize(neuroszx,neuroszy),cvSize(stridex,stridey),cvSize(paddingx,paddingy))
+				);
+			else
+				data.plane.push_back(
+					new CvDepthwisePlane(planeid,cvSize(fmapszx,fmapszy),cvSize(neuroszx,neuroszy),cvSize(stridex,stridey),cvSize(paddingx,paddingy))
+				);
 			data.idmap[planeid] = curplaneid;
-		} else if (planetype=="convolution")
+		} else if (planetype=="pointwise")
 		{
 			data.plane.push_back(
-				new CvConvolutionPlane(planeid,cvSize(fmapszx,fmapszy),cvSize(neuroszx,neuroszy))
+				new CvPointwisePlane(planeid,cvSize(fmapszx,fmapszy))
 			);
 			data.idmap[planeid] = curplaneid;
 		} else if (planetype=="subsampling")
@@ -235,8 +289,16 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 			data.idmap[planeid] = curplaneid;
 		} else if (planetype=="max")
 		{
+			CHK_POSSIBLE_FAIL( select!="max" && select!="min", "max plane "+planeid+" can select only max or min");
 			data.plane.push_back(
-				new CvMaxPlane(planeid)
+				new CvMaxPlane(planeid, select=="min")
+			);
+			data.idmap[planeid] = curplaneid;
+		} else if (planetype=="dense")
+		{
+			CHK_POSSIBLE_FAIL( fmapszy != 1, "dense plane "+planeid+" must have feature map of Nx1 size");
+			data.plane.push_back(
+				new CvDensePlane(planeid,fmapszx,cvSize(neuroszx,neuroszy))
 			);
 			data.idmap[planeid] = curplaneid;
 		} else if (planetype=="regression")
@@ -279,6 +341,30 @@ static void XMLCALL icvXML_StartElementHandler (void *userData, const XML_Char *
 		
 		CHK_POSSIBLE_FAIL(data.cur_type=="max","<bias> defined for max plane");
 	}
+	else if ((namestr == "exit") && (data.depth == 1))
+	// ****** Process <exit> tag
+	{
+		string planeid;
+		double threshold = 0.0;
+		int found = 0;
+
+		for (int i=0; (atts[i]!=NULL) && (atts[i+1]!=NULL); i+=2)
+		{
+			string attr = atts[i];
+			string val = atts[i+1];
+			if (attr=="plane") planeid = val;
+			if (attr=="threshold")
+			{
+				istringstream iss ( val );
+				found = (iss >> threshold) ? 1 : 0;
+			}
+		}
+
+		CHK_POSSIBLE_FAIL( data.idmap.find(planeid) == data.idmap.end(), "exit at non-existing plane \""+planeid+"\"");
+		CHK_POSSIBLE_FAIL( !found, "exit at plane "+planeid+" has no threshold");
+
+		data.exits.push_back(make_pair(planeid,threshold));
+	}
 	else if ((namestr == "info") && (data.depth == 1))
 	{
 		data.isinfo |= INSIDE_TAG; // Mark as inside <info> tag
@@ -308,7 +394,7 @@ static void XMLCALL icvXML_EndElementHandler(void *userData, const XML_Char *nam
 		vector<CvGenericPlane *>::iterator i = data.plane.end()-1;
 		
 		// Check if we found <bias> for certain planes
-		CHK_POSSIBLE_FAIL( (!(data.isbias & FOUND_VALUE)) && (data.cur_type=="convolution" || data.cur_type=="subsampling"), "no bias found");
+		CHK_POSSIBLE_FAIL( (!(data.isbias & FOUND_VALUE)) && (data.cur_type=="convolution" || data.cur_type=="depthwise" || data.cur_type=="pointwise" || data.cur_type=="dense" || data.cur_type=="subsampling"), "no bias found");
 
 		// Check if plane (except source) is connected to something
 		CHK_POSSIBLE_FAIL( (data.cur_parents.size()==0) && (data.cur_type!="source"), "plane is not connected to anything");
@@ -350,9 +436,13 @@ static void XMLCALL icvXML_CharacterDataHandler(void *userData, const XML_Char *
 	if (data.isbias & INSIDE_TAG) 
 	// Process <bias> tag data
 	{
-		if (iss >> w)
+		// Biases go first (dense planes have one per output)
+		vector<double> bias;
+		while (iss >> w)
+			bias.push_back(w);
+		if (!bias.empty())
 		{
-			data.cur_weight.insert(data.cur_weight.begin(),w);
+			data.cur_weight.insert(data.cur_weight.begin(),bias.begin(),bias.end());
 			data.isbias |= FOUND_VALUE; // Mark as found
 		}
 		
@@ -379,7 +469,8 @@ int parse(string xml, string &creator,
 		string &name, 
 		string &info, 
  		vector<CvGenericPlane *> &plane,
-		map<string,int> &idmap)
+		map<string,int> &idmap,
+		vector< pair<string,double> > &exits)
 {
 	XML_Parser parser = XML_ParserCreate(NULL);
 
@@ -392,6 +483,7 @@ int parse(string xml, string &creator,
 
  		plane, // vector<CvGenericPlane *> &plane;
 		idmap, // map<string,int> &idmap;
+		exits, // vector< pair<string,double> > &exits;
 
 		0, // int depth;
 		0, // int isbias;
@@ -0,0 +1,306 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Backend autotuner implementation
+ *
+ * The tuner times every available backend on the actual shapes of 
+ * each plane and makes the plane use the fastest one. Convolutional
+ * planes with several parents are also timed with the parents interleaved
+ * (see CvConvolutionPlane::setlayout()), so the layout is chosen per bank.
+ * Results are stored in a tuning cache file, one line per shape:
+ * \verbatim
+ * <cpu>	<shape key>	<backend>[ hwc]
+ * \endverbatim
+ * The shape key consists of plane type, feature map size, neuron size,
+ * number of parents, feature map size of the first parent and the form 
+ * of the computation (see CvGenericPlane::getform()), such as stride, 
+ * padding and the number of pruned and factored kernels, and the size 
+ * of the group computed by the plane (see CvConvNet::link()). Other 
+ * planes of a group do nothing on their own fprop, so they are not 
+ * timed and use the choice of the leader. Lines of other 
+ * CPUs are kept untouched, so the same cache file can be shared between machines.
+ * \date 2026
+ */
+
+#include <cassert>
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <opencv/cv.h>
+#include "cvconvnettuner.h"
+#include "cvgenericplane.h"
+#include "cvconvolutionplane.h"
+#include "cvbackend.h"
+
+using namespace std;
+
+//! Number of timed runs per backend (the best one counts)
+#define CV_TUNE_RUNS 5
+
+/*!
+ * \return model name of the CPU or "unknown" if it can not be determined
+ */
+static string icvGetCPUName()
+{
+	ifstream cpuinfo("/proc/cpuinfo");
+	string line;
+
+	while (getline(cpuinfo, line))
+	{
+		if (line.compare(0, 10, "model name") != 0)
+			continue;
+
+		string::size_type pos = line.find(':');
+		if (pos == string::npos)
+			break;
+
+		pos = line.find_first_not_of(" \t", pos+1);
+		if (pos == string::npos)
+			break;
+
+		// Tabs are separators of the cache file
+		string name = line.substr(pos);
+		for (int i=0; i<name.size(); i++)
+			if (name[i] == '\t') name[i] = ' ';
+		return name;
+	}
+
+	return "unknown";
+}
+
+/*!
+ * \param plane plane to be described
+ * \param groupsz number of planes computed by the plane
+ * \return key identifying the computation done by the plane
+ */
+static string icvGetShapeKey(CvGenericPlane *plane, int groupsz)
+{
+	ostringstream key;
+	CvMat *fmap = plane->getfmap();
+	CvSize neurosz = plane->getneurosz();
+
+	key << plane->gettype() 
+		<< " " << fmap->cols << "x" << fmap->rows 
+		<< " " << neurosz.width << "x" << neurosz.height
+		<< " " << plane->getparents().size();
+	if (!plane->getparents().empty())
+	{
+		CvMat *pfmap = plane->getparents()[0]->getfmap();
+		key << " " << pfmap->cols << "x" << pfmap->rows;
+	}
+
+	string form = plane->getform();
+	if (!form.empty())
+		key << " " << form;
+	if (groupsz > 1)
+		key << " group " << groupsz;
+	return key.str();
+}
+
+/*! The input has no zero pixels, so the timing does not depend on
+ * what the feature map held before and source planes are not computed
+ * from few nonzero pixels (see CV_SCATTER_DENSITY).
+ * \param fmap feature map of the source plane
+ */
+static void icvFillSynthetic(CvMat *fmap)
+{
+	for (int y=0; y<fmap->rows; y++)
+		for (int x=0; x<fmap->cols; x++)
+			cvmSet(fmap, y, x, 0.1 + ((y*7+x*13)%17)/17.0);
+}
+
+/*!
+ * \param plane plane to be timed
+ * \return best time of plane's fprop in ticks
+ */
+static int64 icvTimeFprop(CvGenericPlane *plane)
+{
+	int64 best = -1;
+
+	// Warm up caches
+	plane->fprop();
+
+	for (int i=0; i<CV_TUNE_RUNS; i++)
+	{
+		int64 start = cvGetTickCount();
+		plane->fprop();
+		int64 t = cvGetTickCount() - start;
+
+		if (best < 0 || t < best)
+			best = t;
+	}
+
+	return best;
+}
+
+/*! The choice is the backend name optionally followed by " hwc" 
+ * for the interleaved layout.
+ * \param plane plane to be configured
+ * \param choice choice as stored in the tuning cache
+ * \return status of operation
+ */
+static int icvApplyChoice(CvGenericPlane *plane, const string &choice)
+{
+	string::size_type sp = choice.find(' ');
+	CvBackend *backend = cvGetBackend(choice.substr(0, sp));
+	if (backend == NULL)
+		return 0;
+
+	plane->setbackend(backend);
+
+	CvConvolutionPlane *conv = dynamic_cast<CvConvolutionPlane *>(plane);
+	if (conv != NULL)
+	{
+		int layout = (sp != string::npos && choice.substr(sp+1) == "hwc") ? CVCONVNET_LAYOUT_HWC : CVCONVNET_LAYOUT_PLANAR;
+		return conv->setlayout(layout);
+	}
+	return sp == string::npos;
+}
+
+/*! The function selects the fastest backend for every plane.
+ * Shapes found in the tuning cache for this CPU are not timed again.
+ * Planes are timed on a fixed synthetic input written to the source
+ * plane, so the feature maps of all planes are overwritten.
+ * \param plane planes of the network in topological order
+ * \param leader index of the plane computing every plane, it precedes the plane
+ * \param cachefile name of the tuning cache file (empty for no cache)
+ * \return status of operation
+ */
+int tune(vector<CvGenericPlane *> &plane, const vector<int> &leader, string cachefile)
+{
+	assert( leader.size() == plane.size() );
+	string cpu = icvGetCPUName();
+	vector<string> lines; // cache lines of other CPUs
+	map<string,string> choice; // shape key -> backend name
+	int changed = 0;
+
+	// Load the cache
+	if (!cachefile.empty())
+	{
+		ifstream in(cachefile.c_str());
+		string line;
+
+		while (getline(in, line))
+		{
+			string::size_type t1 = line.find('\t');
+			string::size_type t2 = (t1 == string::npos) ? t1 : line.find('\t', t1+1);
+
+			if (t2 == string::npos)
+				continue;
+
+			if (line.substr(0, t1) != cpu)
+				lines.push_back(line);
+			else if (cvGetBackend(line.substr(t2+1, line.find(' ', t2+1)-t2-1)) != NULL)
+				choice[line.substr(t1+1, t2-t1-1)] = line.substr(t2+1);
+		}
+	}
+
+	vector<string> names = cvGetBackendNames();
+
+	if (!plane.empty())
+		icvFillSynthetic(plane[0]->getfmap());
+
+	vector<int> groupsz(plane.size(), 0);
+	for (int i=0; i<plane.size(); i++)
+		groupsz[leader[i]]++;
+
+	// Source plane has nothing to compute
+	for (int i=1; i<plane.size(); i++)
+	{
+		assert( plane[i] != NULL && leader[i] <= i );
+		if (leader[i] != i)
+		{
+			plane[i]->setbackend(plane[leader[i]]->getbackend());
+			continue;
+		}
+		string key = icvGetShapeKey(plane[i], groupsz[i]);
+
+		map<string,string>::iterator itr = choice.find(key);
+		if (itr == choice.end())
+		{
+			int64 best = -1;
+			string bestname;
+
+			vector<string> candidates = names;
+			CvConvolutionPlane *conv = dynamic_cast<CvConvolutionPlane *>(plane[i]);
+			if (conv != NULL && conv->getparents().size() > 1 && conv->setlayout(CVCONVNET_LAYOUT_HWC))
+			{
+				for (int j=0; j<names.size(); j++)
+					candidates.push_back(names[j] + " hwc");
+			}
+
+			for (int j=0; j<candidates.size(); j++)
+			{
+				icvApplyChoice(plane[i], candidates[j]);
+				int64 t = icvTimeFprop(plane[i]);
+
+				if (best < 0 || t < best)
+				{
+					best = t;
+					bestname = candidates[j];
+				}
+			}
+
+			itr = choice.insert(make_pair(key, bestname)).first;
+			changed = 1;
+		}
+
+		// Cached layout may not fit the plane, the backend still does
+		if (!icvApplyChoice(plane[i], itr->second))
+			icvApplyChoice(plane[i], itr->second.substr(0, itr->second.find(' ')));
+	}
+
+	// Save the cache
+	if (changed && !cachefile.empty())
+	{
+		ofstream out(cachefile.c_str());
+		if (!out)
+		{
+			cerr << "ERROR: Can not write tuning cache " << cachefile << endl;
+			return 0;
+		}
+
+		for (int i=0; i<lines.size(); i++)
+			out << lines[i] << endl;
+
+		for (map<string,string>::iterator itr = choice.begin(); itr != choice.end(); itr++)
+			out << cpu << "\t" << itr->first << "\t" << itr->second << endl;
+	}
+
+	return 1;
+}
@@ -40,11 +40,36 @@ preliminary and subject to change at any time, without notice.
 
 #include "cvconvolutionplane.h"
 #include "cvfastsigmoid.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 
 using namespace std;
 
+/*! Terms of the decomposition are dropped from the end while the sum of 
+ * their squared singular values (the squared error in Frobenius norm)
+ * stays within the tolerance relative to the squared norm of the kernel.
+ * \param sigma singular values in descending order
+ * \param tolerance relative error
+ * \return number of terms kept
+ */
+static int icvRank(const vector<double> &sigma, double tolerance)
+{
+	double norm = 0.0;
+	for (int t=0; t<sigma.size(); t++)
+		norm += sigma[t]*sigma[t];
+
+	int rank = sigma.size();
+	double error = 0.0;
+	while (rank > 0 && error+sigma[rank-1]*sigma[rank-1] <= tolerance*tolerance*norm)
+	{
+		error += sigma[rank-1]*sigma[rank-1];
+		rank--;
+	}
+	return rank;
+}
+
 // Constructors/Destructors
 //  
 
@@ -56,22 +81,67 @@ using namespace std;
  * \param neurosz size of "neuron window" (for instance 5x5 means that
  * we have a neuron that is connected to 25 outputs of his 
  * parent(s) neuron feature map)
+ * \param stride distance between neuron windows of neighbouring outputs,
+ * output (y,x) sees parents' window starting at (y*stride.height,x*stride.width)
+ * \param padding number of implicit zero rows and columns around parents' 
+ * feature maps, it shifts the window of output (y,x) up and left by the padding
  */
-CvConvolutionPlane::CvConvolutionPlane  (std::string id, CvSize fmapsz, CvSize neurosz)
-	: CvGenericPlane(id, fmapsz, neurosz) 
+CvConvolutionPlane::CvConvolutionPlane  (std::string id, CvSize fmapsz, CvSize neurosz, CvSize stride, CvSize padding)
+	: CvGenericPlane(id, fmapsz, neurosz), m_stride(stride), m_padding(padding)
 {
+	m_activation = CVCONVNET_ACT_TANH;
+	m_leader = this;
+	m_bank.push_back(this);
+	m_layout = CVCONVNET_LAYOUT_PLANAR;
+	m_packed = NULL;
+	m_scratch = NULL;
+
  	// Init weights for the neuron of convolution plane
  	m_weight.resize( neurosz.height*neurosz.width+1 );
 }
 
 CvConvolutionPlane::~CvConvolutionPlane ( ) 
 { 
+	if (m_packed)
+		cvReleaseMat(&m_packed);
+	if (m_scratch)
+		cvReleaseMat(&m_scratch);
 }
 
 //  
 // Methods
 //  
 
+/*! Until the plane joins a bank (see share()) it reads only its own parents.
+ * Kernels of new parents are zero until setweight().
+ * \param pplane parent planes
+ * \return status
+ */
+int CvConvolutionPlane::connto ( std::vector<CvGenericPlane *> &pplane )
+{
+	if (!CvGenericPlane::connto(pplane))
+		return 0;
+
+	m_bankfmap = m_pfmap;
+	m_link.assign(m_pfmap.size(), vector< pair<int,int> >());
+	m_channel.resize(m_pfmap.size());
+	m_sourceparent.resize(m_pfmap.size());
+	for (int i=0; i<m_pfmap.size(); i++)
+	{
+		m_link[i].push_back(make_pair(0, i));
+		m_channel[i] = i;
+		m_sourceparent[i] = (m_pplane[i]->gettype() == "source");
+	}
+
+	// A kernel for every parent
+	m_weight.resize(m_neurosz.width*m_neurosz.height*m_pfmap.size()+1);
+	packweights();
+	compress();
+	factor();
+
+	return 1;
+}
+
 /*! The method forward-propagates data from neuron parents to neuron's 
  * own feature map.
  * Each neuron knows his parents, thus there are no input parameters.
@@ -81,43 +151,338 @@ CvMat * CvConvolutionPlane::fprop ()
 {
     assert( m_connected );
 
-    for (int y=0; y<m_fmapsz.height; y++)
+    return fpropregion(cvRect(0, 0, m_fmapsz.width, m_fmapsz.height));
+}
+
+/*! The method recomputes a region of plane's feature map. 
+ * Neurons of the region only see the region of parents grown by
+ * the neuron window, so the backend gets headers of these regions
+ * (see accumulate()). The leader of a bank (see share()) recomputes 
+ * the region of every plane of the bank, the other planes do nothing.
+ * \param rect region of the feature map to be recomputed
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvConvolutionPlane::fpropregion ( CvRect rect )
+{
+    assert( m_connected );
+    assert( rect.x >= 0 && rect.y >= 0 && rect.x+rect.width <= m_fmapsz.width && rect.y+rect.height <= m_fmapsz.height );
+
+    // Computed by the leader of the bank
+    if (m_leader != this)
+        return m_fmap;
+
+    // Start with the bias and accumulate contribution of every parent
+    vector<CvMat> region(m_bank.size());
+    for (int g = 0; g < m_bank.size(); g++)
+    {
+        cvGetSubRect(m_bank[g]->m_fmap, &region[g], rect);
+        cvSet(&region[g], cvRealScalar(m_bank[g]->m_weight[0]));
+    }
+
+    if (m_layout == CVCONVNET_LAYOUT_HWC)
+    {
+        accumulatepacked(rect, &region[0]);
+    }
+    else
+    {
+        for (int u = 0; u < m_bankfmap.size(); u++)
+            accumulate(u, rect, &region[0]);
+    }
+
+    // "Fast Sigmoid Approximation" trick would be CVCONVNET_ACT_STDSIGMOID
+    if (m_activation != CVCONVNET_ACT_IDENTITY)
     {
-        for (int x=0; x<m_fmapsz.width; x++)
+        for (int g = 0; g < m_bank.size(); g++)
+            m_backend->activate(&region[g], m_activation, 1.0, 0.0);
+    }
+
+    return m_fmap;
+}
+
+/*! Kernels with few nonzero weights (see CV_SPARSE_DENSITY) are sparse,
+ * kernels kept in separable form by factor() are factored.
+ * \param i index of the parent
+ * \return form of the parent's kernel (CVCONVNET_KERNEL_*)
+ */
+int CvConvolutionPlane::getkernelform ( int i )
+{
+	int nnz = m_tap[i].size();
+	if (nnz == 0)
+		return CVCONVNET_KERNEL_ZERO;
+	if (!m_row[i].empty())
+		return CVCONVNET_KERNEL_FACTORED;
+	if (nnz <= CV_SPARSE_DENSITY*m_neurosz.width*m_neurosz.height)
+		return CVCONVNET_KERNEL_SPARSE;
+	return CVCONVNET_KERNEL_DENSE;
+}
+
+/*! The method adds contribution of a parent of the bank to a region of 
+ * the feature maps of the bank. Only planes connected to the parent are
+ * computed, so a sparse connection table costs nothing for absent pairs.
+ * Outputs whose neuron window lies completely inside the parent are 
+ * computed by a single backend call on headers of the regions, the rest
+ * (a frame of at most padding/stride outputs) by the clipped convolution.
+ * Without padding the frame is empty, so the interior call does all the work.
+ * Several planes connected to the parent go through it once with convolvebank().
+ * Source planes with few nonzero pixels (see CV_SCATTER_DENSITY), such as
+ * thin strokes on blank background, go to convolvescatter() instead. The pixels
+ * are counted over the whole source, not the region, so every region of 
+ * an input is computed the same way and fpropregion() gives exactly
+ * the values of fprop().
+ * Pruned kernels with few nonzero weights are computed by convolvesparse()
+ * instead, kernels of low rank by a row and a column pass per term
+ * (see factor()), and kernels pruned completely are skipped.
+ * \param u index of the parent in parents of the bank
+ * \param rect region of the feature map
+ * \param region headers of the region of the feature maps, one per plane of the bank
+ */
+void CvConvolutionPlane::accumulate ( int u, CvRect rect, CvMat *region )
+{
+    int windowsz = m_neurosz.height*m_neurosz.width;
+
+    // Pruned and factored kernels are computed one by one, the rest by the bank
+    vector< pair<int,int> > link, sparse, factored;
+    for (int k = 0; k < m_link[u].size(); k++)
+    {
+        const pair<int,int> &l = m_link[u][k];
+        int form = m_bank[l.first]->getkernelform(l.second);
+        if (form == CVCONVNET_KERNEL_FACTORED)
+            factored.push_back(l);
+        else if (form == CVCONVNET_KERNEL_SPARSE)
+            sparse.push_back(l);
+        else if (form == CVCONVNET_KERNEL_DENSE)
+            link.push_back(l);
+    }
+
+    int n = link.size();
+    vector<const double *> weight(n);
+    for (int k = 0; k < n; k++)
+        weight[k] = &m_bank[link[k].first]->m_weight[1+link[k].second*windowsz];
+    CvMat *pfmap = m_bankfmap[u];
+
+    CvRect inner = getinterior(pfmap, rect);
+    if (inner.width > 0)
+    {
+        CvMat src;
+        cvGetSubRect(pfmap, &src, cvRect((rect.x+inner.x)*m_stride.width-m_padding.width, (rect.y+inner.y)*m_stride.height-m_padding.height, 
+            (inner.width-1)*m_stride.width+m_neurosz.width, (inner.height-1)*m_stride.height+m_neurosz.height));
+
+        vector<CvMat> acc(n);
+        vector<CvMat *> pacc(n);
+        for (int k = 0; k < n; k++)
         {
+            cvGetSubRect(&region[link[k].first], &acc[k], inner);
+            pacc[k] = &acc[k];
+        }
 
-            double sum = m_weight[0]; // bias
-            int w = 0;
-            for (int i = 0; i < m_pplane.size(); i++)
-            {
-                CvMat *fmap = m_pfmap[i];
-                assert( cvGetSize(fmap).height >= y+m_neurosz.height
-                        && cvGetSize(fmap).width >= x+m_neurosz.width );
-                for (int j=0; j<m_neurosz.height; j++)
-                {
-                    for (int k=0; k<m_neurosz.width; k++)
-                    {
-                        sum += m_weight[++w]*cvmGet(fmap, y+j, x+k);
-                    } 
-                }
-            }
+        // Mostly blank input images are computed from their nonzero pixels
+        if (n > 0 && m_sourceparent[u] && cvCountNonZero(pfmap) < CV_SCATTER_DENSITY*pfmap->rows*pfmap->cols)
+            m_backend->convolvescatter(&src, &weight[0], n, m_neurosz, m_stride, &pacc[0]);
+        else if (n > 1)
+            m_backend->convolvebank(&src, &weight[0], n, m_neurosz, m_stride, &pacc[0]);
+        else if (n == 1 && (m_stride.width != 1 || m_stride.height != 1))
+            m_backend->convolvestrided(&src, weight[0], m_neurosz, m_stride, pacc[0]);
+        else if (n == 1)
+            m_backend->convolve(&src, weight[0], m_neurosz, pacc[0]);
 
-            // "Fast Sigmoid Approximation" trick
-            //double val = DQstdsigmoid(sum);
+        for (int k = 0; k < sparse.size(); k++)
+        {
+            CvConvolutionPlane *p = m_bank[sparse[k].first];
+            CvMat acc;
+            cvGetSubRect(&region[sparse[k].first], &acc, inner);
+            m_backend->convolvesparse(&src, &p->m_tap[sparse[k].second][0], &p->m_tapweight[sparse[k].second][0], 
+                p->m_tap[sparse[k].second].size(), m_neurosz, m_stride, &acc);
+        }
 
-// 			// Slow sigmoid, but precise.
-            //double val = 1.71593428*tanh(0.66666666*sum);
-            double val = tanh(sum);
-            //double val = sum;
-            // Update the value at feature map
-            //cout << val << endl;
-            cvmSet(m_fmap,y,x,val);
+        for (int k = 0; k < factored.size(); k++)
+        {
+            CvMat acc;
+            cvGetSubRect(&region[factored[k].first], &acc, inner);
+            accumulatefactored(&src, m_bank[factored[k].first], factored[k].second, &acc);
         }
     }
 
-    return m_fmap;
+    if (inner.width != rect.width || inner.height != rect.height)
+    {
+        link.insert(link.end(), sparse.begin(), sparse.end());
+        link.insert(link.end(), factored.begin(), factored.end());
+
+        CvPoint origin = cvPoint(rect.x*m_stride.width-m_padding.width, rect.y*m_stride.height-m_padding.height);
+        for (int k = 0; k < link.size(); k++)
+            m_backend->convolveclipped(pfmap, &m_bank[link[k].first]->m_weight[1+link[k].second*windowsz], m_neurosz, m_stride, origin, inner, &region[link[k].first]);
+    }
 }
 
+/*! The kernel is the sum of rank one terms column*row^T, so each term
+ * is a convolution of every row of the source with the row factor 
+ * followed by a convolution of the columns of the result with the 
+ * column factor, neurosz.width+neurosz.height multiplications per output
+ * instead of neurosz.width*neurosz.height. The horizontal stride is 
+ * applied by the row pass and the vertical one by the column pass.
+ * \param src region of the parent seen by the outputs
+ * \param plane plane of the bank owning the kernel
+ * \param i index of the parent in the plane's parents
+ * \param acc outputs to accumulate into
+ */
+void CvConvolutionPlane::accumulatefactored ( const CvMat *src, CvConvolutionPlane *plane, int i, CvMat *acc )
+{
+    const vector<double> &column = plane->m_column[i];
+    const vector<double> &row = plane->m_row[i];
+    int rank = row.size()/m_neurosz.width;
+
+    if (m_scratch == NULL || m_scratch->rows < src->rows || m_scratch->cols < acc->cols)
+    {
+        if (m_scratch)
+            cvReleaseMat(&m_scratch);
+        m_scratch = cvCreateMat(src->rows, MAX(acc->cols, m_fmapsz.width), CV_64FC1);
+    }
+    CvMat rows;
+    cvGetSubRect(m_scratch, &rows, cvRect(0, 0, acc->cols, src->rows));
+
+    for (int t = 0; t < rank; t++)
+    {
+        cvSetZero(&rows);
+        if (m_stride.width != 1)
+            m_backend->convolvestrided(src, &row[t*m_neurosz.width], cvSize(m_neurosz.width, 1), cvSize(m_stride.width, 1), &rows);
+        else
+            m_backend->convolve(src, &row[t*m_neurosz.width], cvSize(m_neurosz.width, 1), &rows);
+
+        if (m_stride.height != 1)
+            m_backend->convolvestrided(&rows, &column[t*m_neurosz.height], cvSize(1, m_neurosz.height), cvSize(1, m_stride.height), acc);
+        else
+            m_backend->convolve(&rows, &column[t*m_neurosz.height], cvSize(1, m_neurosz.height), acc);
+    }
+}
+
+/*! The method adds contribution of all parents to a region of the feature
+ * maps of the bank. Parents' windows of the interior are interleaved into
+ * one map first, so every output reads neurosz.height contiguous runs 
+ * instead of neurosz.height runs in each parent, and the copy is shared by
+ * the whole bank. Absent connections of a sparse bank have zero weights 
+ * in this layout, the tuner decides whether it still pays off.
+ * The border is computed from the parents as in accumulate().
+ * \param rect region of the feature map
+ * \param region headers of the region of the feature maps, one per plane of the bank
+ */
+void CvConvolutionPlane::accumulatepacked ( CvRect rect, CvMat *region )
+{
+    int n = m_bank.size();
+    int channels = m_bankfmap.size();
+
+    // setlayout() guarantees parents of the same size
+    CvRect inner = getinterior(m_bankfmap[0], rect);
+    if (inner.width > 0)
+    {
+        CvRect srect = cvRect((rect.x+inner.x)*m_stride.width-m_padding.width, (rect.y+inner.y)*m_stride.height-m_padding.height, 
+            (inner.width-1)*m_stride.width+m_neurosz.width, (inner.height-1)*m_stride.height+m_neurosz.height);
+
+        vector<CvMat> src(channels);
+        vector<const CvMat *> psrc(channels);
+        for (int i = 0; i < channels; i++)
+        {
+            cvGetSubRect(m_bankfmap[i], &src[i], srect);
+            psrc[i] = &src[i];
+        }
+
+        CvMat packed;
+        cvGetSubRect(m_packed, &packed, cvRect(0, 0, srect.width*channels, srect.height));
+        m_backend->interleave(&psrc[0], channels, &packed);
+
+        for (int g = 0; g < n; g++)
+        {
+            CvMat acc;
+            cvGetSubRect(&region[g], &acc, inner);
+            m_backend->convolvepacked(&packed, &m_bank[g]->m_hwcweight[0], channels, m_neurosz, m_stride, &acc);
+        }
+    }
+
+    if (inner.width != rect.width || inner.height != rect.height)
+    {
+        CvPoint origin = cvPoint(rect.x*m_stride.width-m_padding.width, rect.y*m_stride.height-m_padding.height);
+        for (int u = 0; u < channels; u++)
+        {
+            for (int k = 0; k < m_link[u].size(); k++)
+            {
+                const pair<int,int> &l = m_link[u][k];
+                const double *weight = &m_bank[l.first]->m_weight[1+l.second*m_neurosz.height*m_neurosz.width];
+                m_backend->convolveclipped(m_bankfmap[u], weight, m_neurosz, m_stride, origin, inner, &region[l.first]);
+            }
+        }
+    }
+}
+
+/*! Outputs with the window inside the parent satisfy 
+ * ceil(padding/stride) <= y <= (rows+padding-neurosz)/stride.
+ * \param pfmap feature map of the parent
+ * \param rect region of the feature map
+ * \return part of the region with windows inside the parent relative to rect, 
+ * its width and height are zero if there is no such part
+ */
+CvRect CvConvolutionPlane::getinterior ( CvMat *pfmap, CvRect rect )
+{
+    int x0 = MAX((m_padding.width+m_stride.width-1)/m_stride.width, rect.x);
+    int y0 = MAX((m_padding.height+m_stride.height-1)/m_stride.height, rect.y);
+    int x1 = MIN(pfmap->cols+m_padding.width-m_neurosz.width < 0 ? 0 : (pfmap->cols+m_padding.width-m_neurosz.width)/m_stride.width+1, rect.x+rect.width);
+    int y1 = MIN(pfmap->rows+m_padding.height-m_neurosz.height < 0 ? 0 : (pfmap->rows+m_padding.height-m_neurosz.height)/m_stride.height+1, rect.y+rect.height);
+
+    if (x1 <= x0 || y1 <= y0)
+        return cvRect(0, 0, 0, 0);
+
+    return cvRect(x0-rect.x, y0-rect.y, x1-x0, y1-y0);
+}
+
+/*! Output (y,x) sees parent's window starting at (y*stride-padding,x*stride-padding),
+ * so a parent's region shifted by the padding grows by the neuron window towards
+ * the top left corner and is then divided by the stride.
+ * \param prect changed region of a parent's feature map
+ * \return region of plane's feature map to recompute (may be empty)
+ */
+CvRect CvConvolutionPlane::getdirtyrect ( CvRect prect )
+{
+	prect.x += m_padding.width;
+	prect.y += m_padding.height;
+
+	int x0 = (MAX(prect.x-m_neurosz.width+1, 0)+m_stride.width-1)/m_stride.width;
+	int y0 = (MAX(prect.y-m_neurosz.height+1, 0)+m_stride.height-1)/m_stride.height;
+	int x1 = MIN((prect.x+prect.width-1)/m_stride.width+1, m_fmapsz.width);
+	int y1 = MIN((prect.y+prect.height-1)/m_stride.height+1, m_fmapsz.height);
+
+	if (prect.width <= 0 || prect.height <= 0 || x1 <= x0 || y1 <= y0)
+		return cvRect(0,0,0,0);
+
+	return cvRect(x0, y0, x1-x0, y1-y0);
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvConvolutionPlane::gettype ( )
+{
+	return "convolution";
+}
+
+/*! Kernels of all planes computed by the plane are counted by their form
+ * (see getkernelform()), in the order zero, dense, sparse and factored.
+ * \return description of the form
+ */
+string CvConvolutionPlane::getform ( )
+{
+	vector<CvConvolutionPlane *> planes = m_bank;
+	if (planes.empty())
+		planes.push_back(this);
+
+	int count[4] = {0, 0, 0, 0};
+	for (int g=0; g<planes.size(); g++)
+		for (int i=0; i<planes[g]->m_tap.size(); i++)
+			count[planes[g]->getkernelform(i)]++;
+
+	ostringstream form;
+	form << "stride " << m_stride.width << "x" << m_stride.height 
+		<< " padding " << m_padding.width << "x" << m_padding.height
+		<< " kernels " << count[CVCONVNET_KERNEL_ZERO] << "/" << count[CVCONVNET_KERNEL_DENSE] 
+		<< "/" << count[CVCONVNET_KERNEL_SPARSE] << "/" << count[CVCONVNET_KERNEL_FACTORED];
+	return form.str();
+}
 
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
@@ -130,7 +495,13 @@ CvMat * CvConvolutionPlane::fprop ()
 string CvConvolutionPlane::toString ( ) 
 {
 	ostringstream xml;
- 	xml << "\t<plane id=\"" << m_id << "\" type=\"convolution\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
+	xml.precision(CVCONVNET_XML_PRECISION);
+ 	xml << "\t<plane id=\"" << m_id << "\" type=\"" << gettype() << "\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\"";
+	if (m_stride.width != 1 || m_stride.height != 1)
+		xml << " stride=\"" << m_stride.width << "x" << m_stride.height << "\"";
+	if (m_padding.width != 0 || m_padding.height != 0)
+		xml << " padding=\"" << m_padding.width << "x" << m_padding.height << "\"";
+	xml << ">" << endl;
 
 	int windowsz = m_neurosz.height*m_neurosz.width;
 	
@@ -151,18 +522,461 @@ string CvConvolutionPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code computing the feature map of the plane.
+ * The code refers to the weights array and to the feature maps of the
+ * plane and its parents by their symbols (see getsymbol()), all loop
+ * bounds are constants, so the compiler can unroll the neuron window.
+ * The method is mainly used by the code generator of CvConvNet object.
+ * \return string containing C++ statements
+ */
+string CvConvolutionPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+
+	// Index of parent's row and column seen by the output (y,x)
+	ostringstream ys, xs, py, px;
+	ys << "y";
+	xs << "x";
+	if (m_stride.height != 1)
+		ys << "*" << m_stride.height;
+	if (m_stride.width != 1)
+		xs << "*" << m_stride.width;
+	py << ys.str();
+	px << xs.str();
+	if (m_padding.height != 0)
+		py << "-" << m_padding.height;
+	if (m_padding.width != 0)
+		px << "-" << m_padding.width;
+
+	code << "\t/* " << m_id << ": " << gettype() << " " << m_fmapsz.width << "x" << m_fmapsz.height << ", neuron " << m_neurosz.width << "x" << m_neurosz.height;
+	if (m_stride.width != 1 || m_stride.height != 1)
+		code << ", stride " << m_stride.width << "x" << m_stride.height;
+	if (m_padding.width != 0 || m_padding.height != 0)
+		code << ", padding " << m_padding.width << "x" << m_padding.height;
+	code << " */" << endl;
+	code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t\t{" << endl;
+	code << "\t\t\tsum = " << sym << "_w[0];" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		// Padded windows are clipped by the parent
+		ostringstream j0, j1, k0, k1;
+		j0 << 0;
+		j1 << m_neurosz.height;
+		k0 << 0;
+		k1 << m_neurosz.width;
+		if (m_padding.height != 0)
+		{
+			j0.str(""); j1.str("");
+			j0 << "(" << py.str() << " < 0 ? " << m_padding.height << "-" << ys.str() << " : 0)";
+			j1 << "(" << py.str() << " > " << m_pfmap[i]->rows-m_neurosz.height << " ? " << m_pfmap[i]->rows+m_padding.height << "-" << ys.str() << " : " << m_neurosz.height << ")";
+		}
+		if (m_padding.width != 0)
+		{
+			k0.str(""); k1.str("");
+			k0 << "(" << px.str() << " < 0 ? " << m_padding.width << "-" << xs.str() << " : 0)";
+			k1 << "(" << px.str() << " > " << m_pfmap[i]->cols-m_neurosz.width << " ? " << m_pfmap[i]->cols+m_padding.width << "-" << xs.str() << " : " << m_neurosz.width << ")";
+		}
+		code << "\t\t\tfor (j = " << j0.str() << "; j < " << j1.str() << "; j++)" << endl;
+		code << "\t\t\t\tfor (k = " << k0.str() << "; k < " << k1.str() << "; k++)" << endl;
+		code << "\t\t\t\t\tsum += " << sym << "_w[" << i*windowsz+1 << " + j*" << m_neurosz.width << " + k]*s->" << m_pplane[i]->getsymbol() << "[" << py.str() << "+j][" << px.str() << "+k];" << endl;
+	}
+	if (m_activation == CVCONVNET_ACT_TANH)
+		code << "\t\t\ts->" << sym << "[y][x] = tanh(sum);" << endl;
+	else
+		code << "\t\t\ts->" << sym << "[y][x] = sum;" << endl;
+	code << "\t\t}" << endl;
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  * connto() should be invoked BEFORE any attempt to set weights
- * since weights have meaning only when connected
+ * since weights have meaning only when connected.
+ * Only kernels whose weights changed are factored again, so pruning
+ * a few weights does not decompose every kernel.
  * \param weights vector of weights to be set. 
  * The vector should contain all weights for ALL connections 
  * \return status of operation
  */
 int CvConvolutionPlane::setweight(std::vector<double> &weights)
 {	
+	int windowsz = m_neurosz.width*m_neurosz.height;
+
 	// Check that the number of weights passed is sane
-	if (weights.size() != (m_neurosz.width*m_neurosz.height*m_pplane.size()+1))
+	if (weights.size() != (windowsz*m_pplane.size()+1))
+		return 0;
+
+	vector<double> previous = m_weight;
+	if (!CvGenericPlane::setweight(weights))
+		return 0;
+
+	packweights();
+	compress();
+	if (previous.size() != m_weight.size() || m_row.size() != m_pplane.size())
+	{
+		factor();
+		return 1;
+	}
+
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		if (!equal(m_weight.begin()+1+i*windowsz, m_weight.begin()+1+(i+1)*windowsz, previous.begin()+1+i*windowsz))
+			factor(i);
+	}
+	return 1;
+}
+
+/*! Nonzero weights of every parent's kernel are kept in compressed form:
+ * their positions j*neurosz.width+k in the window and their values.
+ */
+void CvConvolutionPlane::compress ( )
+{
+	int windowsz = m_neurosz.width*m_neurosz.height;
+
+	m_tap.assign(m_pplane.size(), vector<int>());
+	m_tapweight.assign(m_pplane.size(), vector<double>());
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		for (int t=0; t<windowsz; t++)
+		{
+			double w = m_weight[1+i*windowsz+t];
+			if (w != 0.0)
+			{
+				m_tap[i].push_back(t);
+				m_tapweight[i].push_back(w);
+			}
+		}
+	}
+}
+
+/*! Kernels whose singular values beyond the first few terms are 
+ * negligible (see CV_FACTOR_EPSILON) are kept as the column factors 
+ * scaled by the singular values and the row factors of these terms,
+ * if the row and column passes are cheaper than the nonzero weights
+ * of the kernel (see isfactorable()). Kernels that are exactly separable
+ * (or approximated by approximate()) are thus computed in this form.
+ */
+void CvConvolutionPlane::factor ( )
+{
+	m_column.assign(m_pplane.size(), vector<double>());
+	m_row.assign(m_pplane.size(), vector<double>());
+	for (int i=0; i<m_pplane.size(); i++)
+		factor(i);
+}
+
+/*! The separable form of the kernel is built again from its weights
+ * (see factor()), compressed form of the kernel must be up to date.
+ * \param i index of the parent
+ */
+void CvConvolutionPlane::factor ( int i )
+{
+	int height = m_neurosz.height, width = m_neurosz.width;
+
+	m_column[i].clear();
+	m_row[i].clear();
+
+	int nnz = m_tap[i].size();
+	if (!isfactorable(1, nnz))
+		return;
+
+	vector<double> sigma, column, row;
+	decompose(i, sigma, column, row);
+	int rank = icvRank(sigma, CV_FACTOR_EPSILON);
+	if (rank == 0 || !isfactorable(rank, nnz))
+		return;
+
+	for (int t=0; t<rank; t++)
+	{
+		for (int j=0; j<height; j++)
+			m_column[i].push_back(sigma[t]*column[t*height+j]);
+		m_row[i].insert(m_row[i].end(), row.begin()+t*width, row.begin()+(t+1)*width);
+	}
+}
+
+/*! The kernel of the parent is the sum of sigma[t]*column[t]*row[t]^T
+ * over min(neurosz.width,neurosz.height) terms in order of descending 
+ * singular values sigma[t]. Wide kernels are transposed for cvSVD().
+ * \param i index of the parent
+ * \param sigma receives singular values
+ * \param column receives column factors, neurosz.height values per term
+ * \param row receives row factors, neurosz.width values per term
+ */
+void CvConvolutionPlane::decompose ( int i, vector<double> &sigma, vector<double> &column, vector<double> &row )
+{
+	int height = m_neurosz.height, width = m_neurosz.width;
+	const double *kernel = &m_weight[1+i*height*width];
+
+	int transposed = (height < width);
+	int m = MAX(height, width), n = MIN(height, width);
+	CvMat *a = cvCreateMat(m, n, CV_64FC1);
+	CvMat *w = cvCreateMat(n, 1, CV_64FC1);
+	CvMat *u = cvCreateMat(m, n, CV_64FC1);
+	CvMat *v = cvCreateMat(n, n, CV_64FC1);
+	for (int j=0; j<height; j++)
+	{
+		for (int k=0; k<width; k++)
+		{
+			if (transposed)
+				cvmSet(a, k, j, kernel[j*width+k]);
+			else
+				cvmSet(a, j, k, kernel[j*width+k]);
+		}
+	}
+	cvSVD(a, w, u, v);
+
+	sigma.resize(n);
+	column.resize(n*height);
+	row.resize(n*width);
+	for (int t=0; t<n; t++)
+	{
+		sigma[t] = cvmGet(w, t, 0);
+		for (int j=0; j<height; j++)
+			column[t*height+j] = transposed ? cvmGet(v, j, t) : cvmGet(u, j, t);
+		for (int k=0; k<width; k++)
+			row[t*width+k] = transposed ? cvmGet(u, k, t) : cvmGet(v, k, t);
+	}
+
+	cvReleaseMat(&a);
+	cvReleaseMat(&w);
+	cvReleaseMat(&u);
+	cvReleaseMat(&v);
+}
+
+/*! A term costs neurosz.width multiplications per row of the parent 
+ * and neurosz.height per output, there are about stride.height rows 
+ * of the parent per output row.
+ * \param rank number of terms
+ * \param nnz number of nonzero weights of the kernel
+ * \return whether the separable form is cheaper than the kernel
+ */
+int CvConvolutionPlane::isfactorable ( int rank, int nnz )
+{
+	return rank*(m_stride.height*m_neurosz.width+m_neurosz.height) < nnz;
+}
+
+/*! Every kernel is replaced by the sum of the fewest terms of its 
+ * singular value decomposition whose error in Frobenius norm is within
+ * the tolerance relative to the norm of the kernel, if the separable 
+ * form of these terms is cheaper than the kernel (see factor()). 
+ * Kernels that are factored already are kept.
+ * \param tolerance relative error of the approximation
+ * \return number of kernels replaced
+ */
+int CvConvolutionPlane::approximate ( double tolerance )
+{
+	int height = m_neurosz.height, width = m_neurosz.width;
+	vector<double> weights = m_weight;
+
+	int replaced = 0;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		int nnz = m_tap[i].size();
+		if (!m_row[i].empty() || !isfactorable(1, nnz))
+			continue;
+
+		vector<double> sigma, column, row;
+		decompose(i, sigma, column, row);
+		int rank = icvRank(sigma, tolerance);
+		if (rank == sigma.size() || !isfactorable(rank, nnz))
+			continue;
+
+		for (int j=0; j<height; j++)
+		{
+			for (int k=0; k<width; k++)
+			{
+				double sum = 0.0;
+				for (int t=0; t<rank; t++)
+					sum += sigma[t]*column[t*height+j]*row[t*width+k];
+				weights[1+i*height*width+j*width+k] = sum;
+			}
+		}
+		replaced++;
+	}
+
+	if (replaced > 0 && !setweight(weights))
+		return 0;
+
+	return replaced;
+}
+
+/*! Weights of the kernels (not the bias) whose magnitude is below
+ * the threshold are set to zero, the kernels are compressed again.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvConvolutionPlane::prune ( double threshold )
+{
+	return pruneweights(threshold, 1);
+}
+
+/*! The window of the parent is removed from the weights.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvConvolutionPlane::removeparent ( int i )
+{
+	int windowsz = m_neurosz.width*m_neurosz.height;
+	if (m_weight.size() != m_pplane.size()*windowsz+1 || !CvGenericPlane::removeparent(i))
 		return 0;
 
-	return CvGenericPlane::setweight(weights);
+	m_weight.erase(m_weight.begin()+1+i*windowsz, m_weight.begin()+1+(i+1)*windowsz);
+	return 1;
+}
+
+/*! Weight of parent i at (j,k) goes to (j*neurosz.width+k)*channels+c
+ * of the weights used with interleaved parents, where c is the index of
+ * the parent in parents of the bank and channels is their number.
+ * Parents of the bank the plane is not connected to get zero weights.
+ */
+void CvConvolutionPlane::packweights ( )
+{
+	int windowsz = m_neurosz.width*m_neurosz.height;
+	int channels = m_leader->m_bankfmap.size();
+
+	// Weights are not set yet
+	m_hwcweight.assign(windowsz*channels, 0.0);
+	if (m_weight.size() != windowsz*m_pplane.size()+1)
+		return;
+
+	for (int i=0; i<m_pplane.size(); i++)
+		for (int t=0; t<windowsz; t++)
+			m_hwcweight[t*channels+m_channel[i]] = m_weight[1+i*windowsz+t];
+}
+
+/*!
+ * \return distance between neuron windows of neighbouring outputs
+ */
+CvSize CvConvolutionPlane::getstride ( )
+{
+	return m_stride;
+}
+
+/*!
+ * \return number of implicit zero columns (width) and rows (height) on each side of parents
+ */
+CvSize CvConvolutionPlane::getpadding ( )
+{
+	return m_padding;
+}
+
+/*! The plane becomes the leader of the bank and computes feature maps of
+ * all its planes in its own fprop. Parents of the bank are all parents of
+ * its planes, every parent is read once for all planes connected to it 
+ * (see CvBackend::convolvebank()) and planes not connected to it are skipped,
+ * so LeNet-like connection tables need no dense weights.
+ * Planes of a bank must have the same type, geometry and activation, 
+ * parents of all of them must be computed before the leader.
+ * \param group planes of the group, the first one must be this plane
+ * \return status of operation
+ */
+int CvConvolutionPlane::share ( std::vector<CvConvolutionPlane *> &group )
+{
+	if (!m_connected || group.empty() || group[0] != this || m_leader != this || m_bank.size() != 1)
+		return 0;
+
+	for (int g=1; g<group.size(); g++)
+	{
+		CvConvolutionPlane *p = group[g];
+		if (!p->m_connected || p->m_leader != p || p->gettype() != gettype()
+			|| p->m_activation != m_activation
+			|| p->m_fmapsz.width != m_fmapsz.width || p->m_fmapsz.height != m_fmapsz.height
+			|| p->m_neurosz.width != m_neurosz.width || p->m_neurosz.height != m_neurosz.height
+			|| p->m_stride.width != m_stride.width || p->m_stride.height != m_stride.height
+			|| p->m_padding.width != m_padding.width || p->m_padding.height != m_padding.height)
+			return 0;
+	}
+
+	// Parents of the bank in order of first appearance
+	m_bankfmap.clear();
+	m_link.clear();
+	m_sourceparent.clear();
+	for (int g=0; g<group.size(); g++)
+	{
+		CvConvolutionPlane *p = group[g];
+		for (int i=0; i<p->m_pfmap.size(); i++)
+		{
+			int u = find(m_bankfmap.begin(), m_bankfmap.end(), p->m_pfmap[i]) - m_bankfmap.begin();
+			if (u == m_bankfmap.size())
+			{
+				m_bankfmap.push_back(p->m_pfmap[i]);
+				m_link.push_back(vector< pair<int,int> >());
+				m_sourceparent.push_back(p->m_pplane[i]->gettype() == "source");
+			}
+			m_link[u].push_back(make_pair(g, i));
+			p->m_channel[i] = u;
+		}
+	}
+
+	for (int g=1; g<group.size(); g++)
+	{
+		group[g]->m_leader = this;
+		group[g]->m_bank.clear();
+		group[g]->m_bankfmap.clear();
+		group[g]->m_link.clear();
+		group[g]->m_sourceparent.clear();
+	}
+	m_bank = group;
+
+	// Interleaved parents are different now
+	setlayout(CVCONVNET_LAYOUT_PLANAR);
+	for (int g=0; g<group.size(); g++)
+		group[g]->packweights();
+
+	return 1;
+}
+
+/*! The interleaved layout pays for copying the parents once per forward 
+ * propagation of the bank, which is worth it when there are enough parents
+ * and planes in the bank reading them. The choice is made per bank by
+ * the tuner (see CvConvNet::tune()), the layout of the leader applies to 
+ * the whole bank. Only planes whose parents have the same size can be 
+ * interleaved.
+ * \param layout CVCONVNET_LAYOUT_PLANAR or CVCONVNET_LAYOUT_HWC
+ * \return status of operation
+ */
+int CvConvolutionPlane::setlayout ( int layout )
+{
+	if (layout == CVCONVNET_LAYOUT_PLANAR)
+	{
+		if (m_packed)
+			cvReleaseMat(&m_packed);
+		m_layout = layout;
+		return 1;
+	}
+
+	if (layout != CVCONVNET_LAYOUT_HWC || !m_connected || m_pplane.empty())
+		return 0;
+
+	// Only the leader of a bank reads the parents
+	if (m_leader != this)
+	{
+		m_layout = layout;
+		return 1;
+	}
+
+	for (int u=1; u<m_bankfmap.size(); u++)
+	{
+		if (m_bankfmap[u]->rows != m_bankfmap[0]->rows || m_bankfmap[u]->cols != m_bankfmap[0]->cols)
+			return 0;
+	}
+
+	if (m_packed == NULL)
+		m_packed = cvCreateMat(m_bankfmap[0]->rows, m_bankfmap[0]->cols*m_bankfmap.size(), CV_64FC1);
+	for (int g=0; g<m_bank.size(); g++)
+		m_bank[g]->packweights();
+	m_layout = layout;
+
+	return 1;
+}
+
+/*!
+ * \return layout in which parents are read (CVCONVNET_LAYOUT_*)
+ */
+int CvConvolutionPlane::getlayout ( )
+{
+	return m_layout;
 }
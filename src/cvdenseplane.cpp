@@ -0,0 +1,355 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of dense plane class
+ * \date 2026
+ */
+
+#include "cvdenseplane.h"
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+/*!
+ * \param id name of the plane
+ * \param noutputs number of outputs
+ * \param neurosz size of neuron window taken from every parent
+ */
+CvDensePlane::CvDensePlane (std::string id, int noutputs, CvSize neurosz)
+	: CvGenericPlane(id, cvSize(noutputs,1), neurosz)
+{
+	m_x = NULL;
+}
+
+CvDensePlane::~CvDensePlane ( )
+{
+	if (m_x)
+		cvReleaseMat(&m_x);
+}
+
+/*! Besides connecting, the method allocates the gathered input row
+ * and the weights, which are stored row by row: the bias of an output
+ * followed by its weights for every parent.
+ * \param pplane parent planes
+ * \return status of operation
+ */
+int CvDensePlane::connto(std::vector<CvGenericPlane *> &pplane)
+{
+	return connect(pplane, 1);
+}
+
+/*! The plane reads the parents like connto() does, but does not become
+ * their child. Groups of regression planes are computed by such a plane
+ * (see CvRegressionPlane::share()), which is not part of the network.
+ * \param pplane parent planes
+ * \return status of operation
+ */
+int CvDensePlane::connhidden(std::vector<CvGenericPlane *> &pplane)
+{
+	return connect(pplane, 0);
+}
+
+/*!
+ * \param pplane parent planes
+ * \param child whether the plane connects back to the parents as their child
+ * \return status of operation
+ */
+int CvDensePlane::connect(std::vector<CvGenericPlane *> &pplane, int child)
+{
+	if (child ? !CvGenericPlane::connto(pplane) : !setparents(pplane))
+		return 0;
+
+	if (m_x)
+		cvReleaseMat(&m_x);
+	m_x = cvCreateMat(1, getrowsz()-1, CV_64FC1);
+	m_weight.assign(m_fmapsz.width*getrowsz(), 0.0);
+	m_index.assign(m_fmapsz.width, vector<int>());
+	m_value.assign(m_fmapsz.width, vector<double>());
+
+	return 1;
+}
+
+/*! The method forward-propagates data from neuron parents to neuron's 
+ * own feature map.
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvDensePlane::fprop ( )
+{
+	assert( m_connected );
+
+	double *x = m_x->data.db;
+	for (int i=0; i<m_pfmap.size(); i++)
+	{
+		assert( m_pfmap[i]->rows >= m_neurosz.height && m_pfmap[i]->cols >= m_neurosz.width );
+		for (int j=0; j<m_neurosz.height; j++)
+		{
+			memcpy(x, m_pfmap[i]->data.ptr + (size_t)m_pfmap[i]->step*j, m_neurosz.width*sizeof(double));
+			x += m_neurosz.width;
+		}
+	}
+
+	// Pruned rows go to the sparse dot product
+	int rowsz = getrowsz();
+	double *out = m_fmap->data.db;
+	for (int o=0; o<m_fmapsz.width; o++)
+	{
+		const double *w = &m_weight[o*rowsz];
+		int nnz = m_index[o].size();
+		if (issparse(o))
+			out[o] = w[0] + (nnz > 0 ? m_backend->dotsparse(m_x, &m_index[o][0], &m_value[o][0], nnz) : 0.0);
+		else
+			out[o] = w[0] + m_backend->dense(m_x, w+1, cvSize(rowsz-1,1));
+	}
+
+	return m_fmap;
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvDensePlane::gettype ( )
+{
+	return "dense";
+}
+
+/*! The method produces an XML representation of the plane.
+ * \return string containing XML description of the plane
+ */
+string CvDensePlane::toString ( )
+{
+	ostringstream xml;
+	xml.precision(CVCONVNET_XML_PRECISION);
+	int rowsz = getrowsz();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+
+	xml << "\t<plane id=\"" << m_id << "\" type=\"dense\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
+
+	xml << "\t\t<bias> ";
+	for (int o=0; o<m_fmapsz.width; o++)
+		xml << m_weight[o*rowsz] << " ";
+	xml << "</bias>" << endl;
+
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		xml << "\t\t<connection to=\"" << m_pplane[i]->getid() << "\"> ";
+		for (int o=0; o<m_fmapsz.width; o++)
+			for (int j=0; j<windowsz; j++)
+				xml << m_weight[o*rowsz+1+i*windowsz+j] << " ";
+		xml << "</connection>" << endl;
+	}
+	xml << "\t</plane>" << endl;
+
+	return xml.str();
+}
+
+/*! The method produces C++ code computing all outputs of the plane.
+ * \return string containing C++ statements
+ */
+string CvDensePlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+	int rowsz = getrowsz();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+
+	code << "\t/* " << m_id << ": dense " << m_fmapsz.width << " outputs, neuron " << m_neurosz.width << "x" << m_neurosz.height << " */" << endl;
+	code << "\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t{" << endl;
+	code << "\t\tsum = " << sym << "_w[x*" << rowsz << "];" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		code << "\t\tfor (j = 0; j < " << m_neurosz.height << "; j++)" << endl;
+		code << "\t\t\tfor (k = 0; k < " << m_neurosz.width << "; k++)" << endl;
+		code << "\t\t\t\tsum += " << sym << "_w[x*" << rowsz << " + " << 1+i*windowsz << " + j*" << m_neurosz.width << " + k]*s->" << m_pplane[i]->getsymbol() << "[j][k];" << endl;
+	}
+	code << "\t\ts->" << sym << "[0][x] = sum;" << endl;
+	code << "\t}" << endl;
+
+	return code.str();
+}
+
+/*! The weights come in XML order: biases of all outputs, then for 
+ * every parent the neuron windows of all outputs.
+ * \param weights vector of weights to be set
+ * \return status of operation
+ */
+int CvDensePlane::setweight(std::vector<double> &weights)
+{
+	int rowsz = getrowsz();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+	int noutputs = m_fmapsz.width;
+
+	if (!m_connected || weights.size() != noutputs*rowsz)
+		return 0;
+
+	for (int o=0; o<noutputs; o++)
+	{
+		m_weight[o*rowsz] = weights[o];
+		for (int i=0; i<m_pplane.size(); i++)
+			for (int j=0; j<windowsz; j++)
+				m_weight[o*rowsz+1+i*windowsz+j] = weights[noutputs+(i*noutputs+o)*windowsz+j];
+		compress(o);
+	}
+
+	return 1;
+}
+
+/*! The weights of an output are the same as the weights of a regression
+ * plane: the bias followed by the neuron window of every parent.
+ * \param output index of the output
+ * \param weights vector of weights to be set
+ * \return status of operation
+ */
+int CvDensePlane::setrow(int output, const std::vector<double> &weights)
+{
+	int rowsz = getrowsz();
+
+	if (!m_connected || output < 0 || output >= m_fmapsz.width || weights.size() != rowsz)
+		return 0;
+
+	copy(weights.begin(), weights.end(), m_weight.begin()+output*rowsz);
+	compress(output);
+	return 1;
+}
+
+/*! Weights of parents (not the biases) of small magnitude are set to zero.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvDensePlane::prune ( double threshold )
+{
+	int rowsz = getrowsz();
+
+	int pruned = 0;
+	for (int o=0; o<m_fmapsz.width; o++)
+	{
+		for (int t=o*rowsz+1; t<(o+1)*rowsz; t++)
+		{
+			if (m_weight[t] != 0.0 && fabs(m_weight[t]) < threshold)
+			{
+				m_weight[t] = 0.0;
+				pruned++;
+			}
+		}
+		compress(o);
+	}
+
+	return pruned;
+}
+
+/*! The window of the parent is removed from the weights of every output.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvDensePlane::removeparent ( int i )
+{
+	int rowsz = getrowsz();
+	int windowsz = m_neurosz.width*m_neurosz.height;
+	if (m_weight.size() != m_fmapsz.width*rowsz || !CvGenericPlane::removeparent(i))
+		return 0;
+
+	// Last output first, so the positions of the others don't move
+	for (int o=m_fmapsz.width-1; o>=0; o--)
+	{
+		vector<double>::iterator first = m_weight.begin()+o*rowsz+1+i*windowsz;
+		m_weight.erase(first, first+windowsz);
+	}
+	return 1;
+}
+
+/*! Nonzero weights of an output are kept in compressed form: their
+ * indices in the gathered row of parents' windows and their values.
+ * \param output index of the output
+ */
+void CvDensePlane::compress ( int output )
+{
+	int rowsz = getrowsz();
+	const double *w = &m_weight[output*rowsz+1];
+
+	m_index[output].clear();
+	m_value[output].clear();
+	for (int t=0; t<rowsz-1; t++)
+	{
+		if (w[t] != 0.0)
+		{
+			m_index[output].push_back(t);
+			m_value[output].push_back(w[t]);
+		}
+	}
+}
+
+/*!
+ * \return number of outputs
+ */
+int CvDensePlane::getoutputs ( )
+{
+	return m_fmapsz.width;
+}
+
+/*! Outputs whose rows are mostly pruned (see CV_SPARSE_DENSITY) are
+ * computed by the sparse dot product.
+ * \param output index of the output
+ * \return whether the output is computed from its nonzero weights only
+ */
+int CvDensePlane::issparse ( int output )
+{
+	return m_index[output].size() <= CV_SPARSE_DENSITY*(getrowsz()-1);
+}
+
+/*!
+ * \return number of outputs computed by the sparse dot product
+ */
+string CvDensePlane::getform ( )
+{
+	int sparse = 0;
+	for (int o=0; o<m_fmapsz.width; o++)
+		sparse += issparse(o);
+
+	ostringstream form;
+	form << "sparse " << sparse;
+	return form.str();
+}
+
+/*!
+ * \return number of weights of one output including the bias
+ */
+int CvDensePlane::getrowsz ( )
+{
+	return m_pplane.size()*m_neurosz.height*m_neurosz.width+1;
+}
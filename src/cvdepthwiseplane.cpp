@@ -0,0 +1,80 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of depthwise convolution plane class
+ * \date 2026
+ */
+
+#include "cvdepthwiseplane.h"
+
+using namespace std;
+
+/*!
+ * \param id name of the plane
+ * \param fmapsz size of the featuremap for this plane
+ * \param neurosz size of "neuron window"
+ * \param stride distance between neuron windows of neighbouring outputs
+ * \param padding number of implicit zero rows and columns around the parent
+ */
+CvDepthwisePlane::CvDepthwisePlane (std::string id, CvSize fmapsz, CvSize neurosz, CvSize stride, CvSize padding)
+	: CvConvolutionPlane(id, fmapsz, neurosz, stride, padding)
+{
+	m_activation = CVCONVNET_ACT_IDENTITY;
+}
+
+CvDepthwisePlane::~CvDepthwisePlane ( )
+{
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvDepthwisePlane::gettype ( )
+{
+	return "depthwise";
+}
+
+/*! Depthwise plane has a single parent, so the weights are the bias
+ * followed by one neuron window.
+ * \param weights vector of weights to be set
+ * \return status of operation
+ */
+int CvDepthwisePlane::setweight(std::vector<double> &weights)
+{
+	if (m_pplane.size() != 1)
+		return 0;
+
+	return CvConvolutionPlane::setweight(weights);
+}
@@ -40,6 +40,8 @@ preliminary and subject to change at any time, without notice.
 
 #include "cvgenericplane.h"
 #include <cassert>
+#include <cctype>
+#include <cmath>
 
 using namespace std;
 
@@ -77,6 +79,8 @@ CvGenericPlane::CvGenericPlane ( std::string id, CvSize fmapsz, CvSize neurosz )
 	
 	m_weight = vector<double> ();
 	m_pplane = vector<CvGenericPlane *> ();
+
+	m_backend = cvGetDefaultBackend();
 }
 
 CvGenericPlane::~CvGenericPlane ( ) 
@@ -96,20 +100,32 @@ CvGenericPlane::~CvGenericPlane ( )
  * \return status
  */
 int CvGenericPlane::connto(vector<CvGenericPlane *> &pplane)
+{
+	setparents(pplane);
+
+	// Connect as a child to every parent
+	for (int i=0; i<m_pplane.size(); i++)
+		m_pplane[i]->connchild(this);				
+
+	return 1;
+}
+
+/*! The plane reads feature maps of the parents, but the parents do not
+ * know it, which suits planes computed on behalf of other planes
+ * and not being part of the network.
+ * \param pplane parent planes
+ * \return status
+ */
+int CvGenericPlane::setparents(vector<CvGenericPlane *> &pplane)
 {
 	m_pplane = pplane;
 	m_connected = 1;
 
+	// Cache pointer to parents' fmaps
 	m_pfmap.resize(m_pplane.size());
 	for (int i=0; i<m_pplane.size(); i++)
-	{
-		// Cache pointer to parents' fmaps
 		m_pfmap[i] = m_pplane[i]->getfmap();
 
-		// Connect as a child to a parent
-		m_pplane[i]->connchild(this);				
-	}
-
 	return 1;
 }
 
@@ -162,6 +178,32 @@ int CvGenericPlane::setfmap ( CvArr * source )
 	return 1;
 }
 
+/*! The method recomputes the given region of plane's feature map 
+ * assuming the rest of the feature map is up to date. The default
+ * implementation just recomputes the whole feature map.
+ * \param rect region of the feature map to be recomputed
+ * \return pointer to feature map of the plane
+ */
+CvMat * CvGenericPlane::fpropregion ( CvRect rect )
+{
+	return fprop();
+}
+
+/*! When a region of parent's feature map changes, only the region of
+ * plane's feature map returned by the method has to be recomputed.
+ * The default implementation assumes that every output depends on 
+ * every input.
+ * \param prect changed region of a parent's feature map
+ * \return region of plane's feature map to recompute (may be empty)
+ */
+CvRect CvGenericPlane::getdirtyrect ( CvRect prect )
+{
+	if (prect.width <= 0 || prect.height <= 0)
+		return cvRect(0,0,0,0);
+
+	return cvRect(0,0,m_fmapsz.width,m_fmapsz.height);
+}
+
 /*!
  * \return pointer to feature map of the plane
  */
@@ -181,6 +223,92 @@ int CvGenericPlane::setweight(std::vector<double> &weights)
 	return 1;
 }
 
+/*! Planes whose weights can be pruned (weights of a weighted sum 
+ * without the bias) override the method, the rest have nothing to prune.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvGenericPlane::prune ( double threshold )
+{
+	return 0;
+}
+
+/*! Planes convolving their parents with kernels override the method,
+ * the rest have nothing to approximate.
+ * \param tolerance relative error of the approximation
+ * \return number of kernels replaced
+ */
+int CvGenericPlane::approximate ( double tolerance )
+{
+	return 0;
+}
+
+/*! Only the list of parents and the weights are updated, the plane
+ * must be connected again before it is propagated 
+ * (CvConvNet::removeplane() reloads the whole network).
+ * Planes without weights of individual parents (subsampling and 
+ * max operator planes) just drop the parent, the rest override the method.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvGenericPlane::removeparent ( int i )
+{
+	if (i < 0 || i >= m_pplane.size())
+		return 0;
+
+	m_pplane.erase(m_pplane.begin()+i);
+	m_pfmap.clear();
+	m_connected = 0;
+	return 1;
+}
+
+/*! The helper of prune() for planes keeping weights of a weighted sum
+ * in m_weight after the bias. The weights are set by setweight(), so 
+ * planes update their derived data as well.
+ * \param threshold magnitude of the smallest weight to keep
+ * \param first index of the first weight that may be pruned
+ * \return number of weights set to zero
+ */
+int CvGenericPlane::pruneweights ( double threshold, int first )
+{
+	vector<double> weights = m_weight;
+
+	int pruned = 0;
+	for (int t=first; t<weights.size(); t++)
+	{
+		if (weights[t] != 0.0 && fabs(weights[t]) < threshold)
+		{
+			weights[t] = 0.0;
+			pruned++;
+		}
+	}
+
+	if (pruned > 0 && !setweight(weights))
+		return 0;
+
+	return pruned;
+}
+
+/*! The confidence is used to decide whether the network may stop
+ * at this plane. By default it is the magnitude of plane's (0,0) value,
+ * which suits output neurons with symmetric activation.
+ * \return confidence of the last computed output
+ */
+double CvGenericPlane::getconfidence ( )
+{
+	return fabs(cvmGet(m_fmap,0,0));
+}
+
+/*! Planes of the same shape may compute their output in different
+ * forms, e.g. with pruned kernels, so the form tells apart planes
+ * of different cost (see tune()). By default there is a single form.
+ * \return description of the form, empty by default
+ */
+string CvGenericPlane::getform ( )
+{
+	return "";
+}
+
 /*!
  * \return string id of the plane
  */
@@ -188,3 +316,65 @@ string CvGenericPlane::getid()
 {
 	return m_id;
 }
+
+/*!
+ * The symbol is derived from the string id by replacing every character
+ * that is not allowed in a C identifier by an underscore, so two
+ * different ids may map into the same symbol.
+ * \return identifier of the plane for generated code
+ */
+string CvGenericPlane::getsymbol()
+{
+	string sym = "p_" + m_id;
+	for (int i=2; i<sym.size(); i++)
+	{
+		if ( !isalnum((unsigned char) sym[i]) )
+			sym[i] = '_';
+	}
+	return sym;
+}
+
+/*!
+ * \return weights of plane's neuron (bias first for planes that have one)
+ */
+const vector<double> & CvGenericPlane::getweight()
+{
+	return m_weight;
+}
+
+/*!
+ * \return size of "neuron window" of the plane
+ */
+CvSize CvGenericPlane::getneurosz()
+{
+	return m_neurosz;
+}
+
+/*!
+ * \return parent planes in the order of connection
+ */
+const vector<CvGenericPlane *> & CvGenericPlane::getparents()
+{
+	return m_pplane;
+}
+
+/*!
+ * \param backend backend to be used by fprop of the plane
+ * \return status
+ */
+int CvGenericPlane::setbackend(CvBackend *backend)
+{
+	if (backend == NULL)
+		return 0;
+
+	m_backend = backend;
+	return 1;
+}
+
+/*!
+ * \return backend used by fprop of the plane
+ */
+CvBackend * CvGenericPlane::getbackend()
+{
+	return m_backend;
+}
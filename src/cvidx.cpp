@@ -0,0 +1,126 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+
+/*!\file
+ * \brief Implementation of IDX file reader
+ * \date 2026
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "cvidx.h"
+
+using namespace std;
+
+/*!
+ * \param buf 4 bytes in big endian order
+ * \return the integer
+ */
+static int icvBigEndian(const unsigned char *buf)
+{
+	return (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+}
+
+/*! Elements keep their type: unsigned bytes of MNIST images and labels
+ * become CV_8UC1, floats CV_32FC1 and so on. Multi-byte elements are 
+ * converted from big endian. A file of N 28x28 images gives N x 784 matrix,
+ * a file of N labels N x 1 matrix.
+ * \param filename name of the IDX file
+ * \param dims receives all dimensions of the file if not NULL
+ * \return matrix owned by the caller or NULL if the file can't be read
+ */
+CvMat *cvLoadIDX( std::string filename, std::vector<int> *dims )
+{
+	ifstream in(filename.c_str(), ios::in | ios::binary);
+	unsigned char magic[4];
+
+	if (!in.read((char *) magic, 4) || magic[0] != 0 || magic[1] != 0 || magic[3] == 0)
+	{
+		cerr << "ERROR: " << filename << " is not an IDX file" << endl;
+		return NULL;
+	}
+
+	int type, size;
+	switch (magic[2])
+	{
+		case 0x08: type = CV_8UC1; size = 1; break;
+		case 0x09: type = CV_8SC1; size = 1; break;
+		case 0x0B: type = CV_16SC1; size = 2; break;
+		case 0x0C: type = CV_32SC1; size = 4; break;
+		case 0x0D: type = CV_32FC1; size = 4; break;
+		case 0x0E: type = CV_64FC1; size = 8; break;
+		default:
+			cerr << "ERROR: Unknown element type of IDX file " << filename << endl;
+			return NULL;
+	}
+
+	vector<int> dim(magic[3]);
+	for (int i=0; i<dim.size(); i++)
+	{
+		unsigned char buf[4];
+		if (!in.read((char *) buf, 4) || icvBigEndian(buf) <= 0)
+		{
+			cerr << "ERROR: Wrong dimensions of IDX file " << filename << endl;
+			return NULL;
+		}
+		dim[i] = icvBigEndian(buf);
+	}
+
+	int cols = 1;
+	for (int i=1; i<dim.size(); i++)
+		cols *= dim[i];
+
+	CvMat *mat = cvCreateMat(dim[0], cols, type);
+	for (int y=0; y<mat->rows; y++)
+	{
+		unsigned char *row = mat->data.ptr + (size_t)mat->step*y;
+		if (!in.read((char *) row, (size_t)cols*size))
+		{
+			cerr << "ERROR: IDX file " << filename << " is truncated" << endl;
+			cvReleaseMat(&mat);
+			return NULL;
+		}
+
+		// Byte order of the file is big endian, the machine's is little endian
+		for (int x=0; size > 1 && x<cols; x++)
+			reverse(row+x*size, row+(x+1)*size);
+	}
+
+	if (dims)
+		*dims = dim;
+
+	return mat;
+}
@@ -0,0 +1,700 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of low-level kernels used by planes
+ *
+ * Generic kernels take the neuron window size at runtime, so their
+ * innermost loops can't be unrolled by the compiler. For the window 
+ * sizes used in practice there are template instances with the window
+ * size known at compile time: the window loops are unrolled completely
+ * and the weights can stay in registers for a whole row of outputs.
+ * The dispatch functions pick the specialized instance when one exists
+ * and fall back to the generic loop otherwise.
+ * \date 2026
+ */
+
+#include "cvkernels.h"
+#include "cvbackend.h"
+#include "cvfastsigmoid.h"
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <math.h>
+
+//! Pointer to the beginning of the row of CV_64FC1 matrix
+#define ICV_ROW(mat,y) ((double *)((mat)->data.ptr + (size_t)(mat)->step*(y)))
+
+// ***********************************************************************
+// ************************** Generic kernels ****************************
+// ***********************************************************************
+
+void icvConvolveGeneric(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows+neurosz.height-1 && src->cols >= acc->cols+neurosz.width-1 );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y+j)+x;
+				for (int k=0; k<neurosz.width; k++)
+				{
+					sum += (*w++)*s[k];
+				}
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+void icvConvolveStridedGeneric(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	assert( src->rows >= (acc->rows-1)*stride.height+neurosz.height && src->cols >= (acc->cols-1)*stride.width+neurosz.width );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+				for (int k=0; k<neurosz.width; k++)
+				{
+					sum += (*w++)*s[k];
+				}
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+/*! One row of outputs of B planes: every source value of a neuron window
+ * is loaded once and multiplied by the weights of all B planes, the B sums
+ * stay in registers.
+ */
+template <int B>
+static void icvConvolveBankRow(const CvMat *src, const double **weight, CvSize neurosz, CvSize stride, CvMat **acc, int y)
+{
+	double *dst[B];
+	for (int b=0; b<B; b++)
+		dst[b] = ICV_ROW(acc[b],y);
+
+	for (int x=0; x<acc[0]->cols; x++)
+	{
+		double sum[B];
+		for (int b=0; b<B; b++)
+			sum[b] = dst[b][x];
+
+		int widx = 0;
+		for (int j=0; j<neurosz.height; j++)
+		{
+			const double *s = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+			for (int k=0; k<neurosz.width; k++, widx++)
+			{
+				double v = s[k];
+				for (int b=0; b<B; b++)
+					sum[b] += weight[b][widx]*v;
+			}
+		}
+
+		for (int b=0; b<B; b++)
+			dst[b][x] = sum[b];
+	}
+}
+
+/*! Planes are processed in blocks of four for every output row, so
+ * the neurosz.height source rows seen by the row are read once per block
+ * instead of once per plane, and they stay in L1 between the blocks.
+ * The order of additions is the same as in icvConvolveStridedGeneric().
+ */
+void icvConvolveBankGeneric(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	if (n <= 0)
+		return;
+
+	assert( src->rows >= (acc[0]->rows-1)*stride.height+neurosz.height && src->cols >= (acc[0]->cols-1)*stride.width+neurosz.width );
+
+	for (int y=0; y<acc[0]->rows; y++)
+	{
+		int b = 0;
+		for (; b+4<=n; b+=4)
+			icvConvolveBankRow<4>(src, weight+b, neurosz, stride, acc+b, y);
+		for (; b<n; b++)
+			icvConvolveBankRow<1>(src, weight+b, neurosz, stride, acc+b, y);
+	}
+}
+
+/*! Output (y,x) sees the window of src starting at 
+ * (origin.y+y*stride.height, origin.x+x*stride.width). Only the part
+ * of the window inside src contributes, which is the same as padding 
+ * src with zeros. Outputs inside skip rectangle are not touched, they
+ * are meant to be computed by a faster kernel on the interior.
+ */
+void icvConvolveClipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc)
+{
+	for (int y=0; y<acc->rows; y++)
+	{
+		int sy = origin.y+y*stride.height;
+		int j0 = MAX(-sy, 0), j1 = MIN(src->rows-sy, neurosz.height);
+		bool skiprow = (y >= skip.y && y < skip.y+skip.height);
+
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			if (skiprow && x == skip.x)
+			{
+				x += skip.width-1;
+				continue;
+			}
+
+			int sx = origin.x+x*stride.width;
+			int k0 = MAX(-sx, 0), k1 = MIN(src->cols-sx, neurosz.width);
+
+			double sum = dst[x];
+			for (int j=j0; j<j1; j++)
+			{
+				const double *s = ICV_ROW(src,sy+j)+sx;
+				const double *w = weight+j*neurosz.width;
+				for (int k=k0; k<k1; k++)
+				{
+					sum += w[k]*s[k];
+				}
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+/*! In the interleaved layout the neuron window of all channels in one
+ * source row is a contiguous run of neurosz.width*channels values, so 
+ * every output is neurosz.height plain dot products.
+ */
+void icvConvolvePackedGeneric(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	int len = neurosz.width*channels;
+	assert( src->rows >= (acc->rows-1)*stride.height+neurosz.height && src->cols >= ((acc->cols-1)*stride.width+neurosz.width)*channels );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*stride.height+j)+x*stride.width*channels;
+				for (int t=0; t<len; t++)
+				{
+					sum += (*w++)*s[t];
+				}
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+/*! dst(y,x*n+i) = src[i](y,x), the size of dst defines the region copied.
+ */
+void icvInterleave(const CvMat **src, int n, CvMat *dst)
+{
+	int cols = dst->cols/n;
+	for (int i=0; i<n; i++)
+	{
+		assert( src[i]->rows >= dst->rows && src[i]->cols >= cols );
+
+		for (int y=0; y<dst->rows; y++)
+		{
+			const double *s = ICV_ROW(src[i],y);
+			double *d = ICV_ROW(dst,y)+i;
+			for (int x=0; x<cols; x++)
+			{
+				d[x*n] = s[x];
+			}
+		}
+	}
+}
+
+/*! Taps are positions j*neurosz.width+k of nonzero weights in the window,
+ * they are turned into offsets from the window origin in src once per call,
+ * so every output costs one multiply-add per nonzero weight.
+ */
+void icvConvolveSparseGeneric(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	assert( src->rows >= (acc->rows-1)*stride.height+neurosz.height && src->cols >= (acc->cols-1)*stride.width+neurosz.width );
+
+	std::vector<int> offset(n);
+	for (int t=0; t<n; t++)
+		offset[t] = (tap[t]/neurosz.width)*(src->step/sizeof(double)) + tap[t]%neurosz.width;
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		const double *s = ICV_ROW(src,y*stride.height);
+		for (int x=0; x<acc->cols; x++, s+=stride.width)
+		{
+			double sum = dst[x];
+			for (int t=0; t<n; t++)
+			{
+				sum += weight[t]*s[offset[t]];
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+/*! Instead of gathering the window of every output, every nonzero element
+ * of src at (r,c) is added to the outputs whose windows contain it, 
+ * output (y,x) getting it with the weight at (r-y*stride.height,c-x*stride.width).
+ * Zero elements cost a comparison only, so the work is proportional to 
+ * the number of nonzero elements. The order of additions differs from
+ * the gathering kernels, so results may differ in rounding.
+ */
+void icvConvolveScatterGeneric(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	if (n <= 0)
+		return;
+
+	assert( src->rows >= (acc[0]->rows-1)*stride.height+neurosz.height && src->cols >= (acc[0]->cols-1)*stride.width+neurosz.width );
+
+	int rows = acc[0]->rows, cols = acc[0]->cols;
+	for (int r=0; r<src->rows; r++)
+	{
+		const double *s = ICV_ROW(src,r);
+
+		// Outputs whose windows contain the row
+		int y0 = (r < neurosz.height) ? 0 : (r-neurosz.height+stride.height)/stride.height;
+		int y1 = MIN(r/stride.height, rows-1);
+		if (y1 < y0)
+			continue;
+
+		for (int c=0; c<src->cols; c++)
+		{
+			double v = s[c];
+			if (v == 0.0)
+				continue;
+
+			int x0 = (c < neurosz.width) ? 0 : (c-neurosz.width+stride.width)/stride.width;
+			int x1 = MIN(c/stride.width, cols-1);
+
+			for (int y=y0; y<=y1; y++)
+			{
+				int j = r-y*stride.height;
+				for (int i=0; i<n; i++)
+				{
+					double *d = ICV_ROW(acc[i],y);
+					const double *w = weight[i]+j*neurosz.width+c;
+					for (int x=x0; x<=x1; x++)
+					{
+						d[x] += w[-x*stride.width]*v;
+					}
+				}
+			}
+		}
+	}
+}
+
+/*! The destination is traversed once row by row, every row gets 
+ * contributions of all parents while it stays in cache.
+ */
+void icvCombineGeneric(const CvMat **src, const double *weight, int n, CvMat *acc)
+{
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int i=0; i<n; i++)
+		{
+			assert( src[i]->rows >= acc->rows && src[i]->cols >= acc->cols );
+
+			const double *s = ICV_ROW(src[i],y);
+			double w = weight[i];
+			for (int x=0; x<acc->cols; x++)
+			{
+				dst[x] += w*s[x];
+			}
+		}
+	}
+}
+
+void icvSumPoolGeneric(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows*neurosz.height && src->cols >= acc->cols*neurosz.width );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*neurosz.height+j)+x*neurosz.width;
+				for (int k=0; k<neurosz.width; k++)
+				{
+					sum += s[k];
+				}
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+void icvMaxPoolGeneric(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows*neurosz.height && src->cols >= acc->cols*neurosz.width );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double val = dst[x];
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*neurosz.height+j)+x*neurosz.width;
+				for (int k=0; k<neurosz.width; k++)
+				{
+					val = std::max(val, s[k]);
+				}
+			}
+			dst[x] = val;
+		}
+	}
+}
+
+double icvDotGeneric(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	assert( src->rows >= neurosz.height && src->cols >= neurosz.width );
+
+	double sum = 0;
+	for (int j=0; j<neurosz.height; j++)
+	{
+		const double *s = ICV_ROW(src,j);
+		for (int k=0; k<neurosz.width; k++)
+		{
+			sum += (*weight++)*s[k];
+		}
+	}
+	return sum;
+}
+
+double icvDotSparseGeneric(const CvMat *src, const int *index, const double *weight, int n)
+{
+	assert( CV_IS_MAT_CONT(src->type) );
+
+	const double *s = src->data.db;
+	double sum = 0.0;
+	for (int t=0; t<n; t++)
+	{
+		sum += weight[t]*s[index[t]];
+	}
+	return sum;
+}
+
+double icvDistGeneric(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	assert( src->rows >= neurosz.height && src->cols >= neurosz.width );
+
+	double sum = 0;
+	for (int j=0; j<neurosz.height; j++)
+	{
+		const double *s = ICV_ROW(src,j);
+		for (int k=0; k<neurosz.width; k++)
+		{
+			double d = (*weight++)-s[k];
+			sum += d*d;
+		}
+	}
+	return sum;
+}
+
+void icvActivate(CvMat *fmap, int activation, double scale, double shift)
+{
+	for (int y=0; y<fmap->rows; y++)
+	{
+		double *row = ICV_ROW(fmap,y);
+		switch (activation)
+		{
+		case CVCONVNET_ACT_TANH:
+			for (int x=0; x<fmap->cols; x++)
+				row[x] = tanh(scale*row[x]+shift);
+			break;
+		case CVCONVNET_ACT_STDSIGMOID:
+			for (int x=0; x<fmap->cols; x++)
+				row[x] = DQstdsigmoid(scale*row[x]+shift);
+			break;
+		default:
+			for (int x=0; x<fmap->cols; x++)
+				row[x] = scale*row[x]+shift;
+		}
+	}
+}
+
+int icvArgmax(const double *val, int n)
+{
+	assert( n > 0 );
+	return std::max_element(val, val+n) - val;
+}
+
+// ***********************************************************************
+// ************************ Specialized kernels **************************
+// ***********************************************************************
+
+//! Convolution with the window size known at compile time
+template <int KH, int KW>
+static void icvConvolveFixed(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	assert( neurosz.height == KH && neurosz.width == KW );
+	assert( src->rows >= acc->rows+KH-1 && src->cols >= acc->cols+KW-1 );
+
+	// Local copy lets the compiler keep the weights in registers
+	double w[KH*KW];
+	for (int i=0; i<KH*KW; i++)
+		w[i] = weight[i];
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		const double *s[KH];
+		for (int j=0; j<KH; j++)
+			s[j] = ICV_ROW(src,y+j);
+
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					sum += w[j*KW+k]*s[j][x+k];
+			dst[x] = sum;
+		}
+	}
+}
+
+//! Strided convolution with the window size known at compile time
+template <int KH, int KW>
+static void icvConvolveStridedFixed(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	assert( neurosz.height == KH && neurosz.width == KW );
+	assert( src->rows >= (acc->rows-1)*stride.height+KH && src->cols >= (acc->cols-1)*stride.width+KW );
+
+	double w[KH*KW];
+	for (int i=0; i<KH*KW; i++)
+		w[i] = weight[i];
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		const double *s[KH];
+		for (int j=0; j<KH; j++)
+			s[j] = ICV_ROW(src,y*stride.height+j);
+
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0, sx=0; x<acc->cols; x++, sx+=stride.width)
+		{
+			double sum = dst[x];
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					sum += w[j*KW+k]*s[j][sx+k];
+			dst[x] = sum;
+		}
+	}
+}
+
+//! Sum pooling with the window size known at compile time
+template <int KH, int KW>
+static void icvSumPoolFixed(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( neurosz.height == KH && neurosz.width == KW );
+	assert( src->rows >= acc->rows*KH && src->cols >= acc->cols*KW );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		const double *s[KH];
+		for (int j=0; j<KH; j++)
+			s[j] = ICV_ROW(src,y*KH+j);
+
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					sum += s[j][x*KW+k];
+			dst[x] = sum;
+		}
+	}
+}
+
+//! Max pooling with the window size known at compile time
+template <int KH, int KW>
+static void icvMaxPoolFixed(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( neurosz.height == KH && neurosz.width == KW );
+	assert( src->rows >= acc->rows*KH && src->cols >= acc->cols*KW );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		const double *s[KH];
+		for (int j=0; j<KH; j++)
+			s[j] = ICV_ROW(src,y*KH+j);
+
+		double *dst = ICV_ROW(acc,y);
+		for (int x=0; x<acc->cols; x++)
+		{
+			double val = dst[x];
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					val = std::max(val, s[j][x*KW+k]);
+			dst[x] = val;
+		}
+	}
+}
+
+// ***********************************************************************
+// ************************** Dispatch tables ****************************
+// ***********************************************************************
+
+//! Entry of convolution dispatch table
+typedef struct
+{
+	int height;		//!< Neuron window height
+	int width;		//!< Neuron window width
+	CvConvKernel kernel;	//!< Kernel specialized for this window
+} CvConvKernelEntry;
+
+//! Entry of strided convolution dispatch table
+typedef struct
+{
+	int height;		//!< Neuron window height
+	int width;		//!< Neuron window width
+	CvStridedConvKernel kernel;	//!< Kernel specialized for this window
+} CvStridedConvKernelEntry;
+
+//! Entry of pooling dispatch table
+typedef struct
+{
+	int height;		//!< Neuron window height
+	int width;		//!< Neuron window width
+	CvPoolKernel kernel;	//!< Kernel specialized for this window
+} CvPoolKernelEntry;
+
+static const CvConvKernelEntry icvConvKernels[] =
+{
+	{ 3, 3, icvConvolveFixed<3,3> },
+	{ 5, 5, icvConvolveFixed<5,5> },
+	{ 7, 7, icvConvolveFixed<7,7> }
+};
+
+static const CvStridedConvKernelEntry icvStridedConvKernels[] =
+{
+	{ 3, 3, icvConvolveStridedFixed<3,3> },
+	{ 5, 5, icvConvolveStridedFixed<5,5> },
+	{ 7, 7, icvConvolveStridedFixed<7,7> }
+};
+
+static const CvPoolKernelEntry icvSumPoolKernels[] =
+{
+	{ 2, 2, icvSumPoolFixed<2,2> },
+	{ 3, 3, icvSumPoolFixed<3,3> }
+};
+
+static const CvPoolKernelEntry icvMaxPoolKernels[] =
+{
+	{ 2, 2, icvMaxPoolFixed<2,2> },
+	{ 3, 3, icvMaxPoolFixed<3,3> }
+};
+
+/*!
+ * \param neurosz size of neuron window
+ * \return specialized kernel for the window or the generic one
+ */
+CvConvKernel icvGetConvKernel(CvSize neurosz)
+{
+	for (int i=0; i<sizeof(icvConvKernels)/sizeof(icvConvKernels[0]); i++)
+	{
+		if (icvConvKernels[i].height == neurosz.height && icvConvKernels[i].width == neurosz.width)
+			return icvConvKernels[i].kernel;
+	}
+	return icvConvolveGeneric;
+}
+
+/*!
+ * \param neurosz size of neuron window
+ * \return specialized kernel for the window or the generic one
+ */
+CvStridedConvKernel icvGetStridedConvKernel(CvSize neurosz)
+{
+	for (int i=0; i<sizeof(icvStridedConvKernels)/sizeof(icvStridedConvKernels[0]); i++)
+	{
+		if (icvStridedConvKernels[i].height == neurosz.height && icvStridedConvKernels[i].width == neurosz.width)
+			return icvStridedConvKernels[i].kernel;
+	}
+	return icvConvolveStridedGeneric;
+}
+
+/*!
+ * \param neurosz size of neuron window
+ * \return specialized kernel for the window or the generic one
+ */
+CvPoolKernel icvGetSumPoolKernel(CvSize neurosz)
+{
+	for (int i=0; i<sizeof(icvSumPoolKernels)/sizeof(icvSumPoolKernels[0]); i++)
+	{
+		if (icvSumPoolKernels[i].height == neurosz.height && icvSumPoolKernels[i].width == neurosz.width)
+			return icvSumPoolKernels[i].kernel;
+	}
+	return icvSumPoolGeneric;
+}
+
+/*!
+ * \param neurosz size of neuron window
+ * \return specialized kernel for the window or the generic one
+ */
+CvPoolKernel icvGetMaxPoolKernel(CvSize neurosz)
+{
+	for (int i=0; i<sizeof(icvMaxPoolKernels)/sizeof(icvMaxPoolKernels[0]); i++)
+	{
+		if (icvMaxPoolKernels[i].height == neurosz.height && icvMaxPoolKernels[i].width == neurosz.width)
+			return icvMaxPoolKernels[i].kernel;
+	}
+	return icvMaxPoolGeneric;
+}
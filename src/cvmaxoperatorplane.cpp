@@ -41,6 +41,7 @@ preliminary and subject to change at any time, without notice.
 #include "cvmaxoperatorplane.h"
 #include "cvfastsigmoid.h"
 #include <math.h>
+#include <float.h>
 #include <iostream>
 #include <sstream>
 
@@ -62,7 +63,6 @@ CvMaxOperatorPlane::CvMaxOperatorPlane (std::string id, CvSize fmapsz, CvSize ne
 	: CvGenericPlane(id, fmapsz, neurosz) 
 {
 	m_weight.resize( 2 );
-	
 }
 
 CvMaxOperatorPlane::~CvMaxOperatorPlane ( ) 
@@ -76,45 +76,81 @@ CvMaxOperatorPlane::~CvMaxOperatorPlane ( )
 /*! The method forward-propagates data from neuron parents to neuron's 
  * own feature map.
  * Each max operator neuron knows his parents, thus there are no input parameters.
+ * Every value of the feature map is the maximum over the corresponding
+ * non-overlapping window of all parents.
  * \return Pointer to plane's featuremap
  */
 CvMat * CvMaxOperatorPlane::fprop()
 {
     assert( m_connected );
-    for (int row = 0; row < m_fmapsz.height / m_neurosz.height; row++)
+
+    cvSet(m_fmap, cvRealScalar(-DBL_MAX));
+
+    // Probably only going to be one input feature map anyway
+    for (int pfmap_index = 0; pfmap_index < m_pplane.size(); pfmap_index++)
     {
-        for (int col = 0; col < m_fmapsz.width / m_neurosz.width; col++)
-        {
-            double max_so_far = -1000.0;
-            // Probably only going to be one input feature map anyway
-            for (int pfmap_index = 0; pfmap_index < m_pplane.size(); pfmap_index++)
-            {
-               CvMat *fmap = m_pfmap[pfmap_index]; 
-               for (int filter_row = 0; filter_row < m_neurosz.height; filter_row++)
-               {
-                   for (int filter_col = 0; filter_col < m_neurosz.width; filter_col++)
-                   {
-                       double fmap_value = cvmGet(fmap, 
-                                                  (row * m_neurosz.height)
-                                                  + filter_row, 
-                                                  (col * m_neurosz.width)
-                                                  + filter_col);
-                       if (fmap_value > max_so_far)
-                       {
-                           max_so_far = fmap_value;
-                       } // if
-                   } // for filter_col
-               } // for filter_row
-            } // for pfmap_index
-
-            cvmSet(m_fmap, row, col, max_so_far);
-        } // for col
-    } // for row
+        m_backend->maxpool(m_pfmap[pfmap_index], m_neurosz, m_fmap);
+    } // for pfmap_index
 
     return m_fmap;
 } // CvMaxOperatorPlane::fprop() 
 
 
+/*! The method recomputes a region of plane's feature map.
+ * \param rect region of the feature map to be recomputed
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvMaxOperatorPlane::fpropregion(CvRect rect)
+{
+    assert( m_connected );
+    assert( rect.x >= 0 && rect.y >= 0 && rect.x+rect.width <= m_fmapsz.width && rect.y+rect.height <= m_fmapsz.height );
+
+    CvMat region, pregion;
+    cvGetSubRect(m_fmap, &region, rect);
+    cvSet(&region, cvRealScalar(-DBL_MAX));
+
+    CvRect prect = cvRect(rect.x*m_neurosz.width, rect.y*m_neurosz.height,
+                          rect.width*m_neurosz.width, rect.height*m_neurosz.height);
+    for (int pfmap_index = 0; pfmap_index < m_pplane.size(); pfmap_index++)
+    {
+        cvGetSubRect(m_pfmap[pfmap_index], &pregion, prect);
+        m_backend->maxpool(&pregion, m_neurosz, &region);
+    } // for pfmap_index
+
+    return m_fmap;
+} // CvMaxOperatorPlane::fpropregion()
+
+
+/*! Windows don't overlap, so a parent's region maps into
+ * the windows it touches.
+ * \param prect changed region of a parent's feature map
+ * \return region of plane's feature map to recompute (may be empty)
+ */
+CvRect CvMaxOperatorPlane::getdirtyrect(CvRect prect)
+{
+    if (prect.width <= 0 || prect.height <= 0)
+        return cvRect(0, 0, 0, 0);
+
+    int x0 = prect.x / m_neurosz.width;
+    int y0 = prect.y / m_neurosz.height;
+    int x1 = MIN((prect.x + prect.width - 1) / m_neurosz.width + 1, m_fmapsz.width);
+    int y1 = MIN((prect.y + prect.height - 1) / m_neurosz.height + 1, m_fmapsz.height);
+
+    if (x1 <= x0 || y1 <= y0)
+        return cvRect(0, 0, 0, 0);
+
+    return cvRect(x0, y0, x1 - x0, y1 - y0);
+} // CvMaxOperatorPlane::getdirtyrect()
+
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvMaxOperatorPlane::gettype ( )
+{
+    return "maxoperator";
+}
+
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
  * parents.
@@ -126,7 +162,8 @@ CvMat * CvMaxOperatorPlane::fprop()
 string CvMaxOperatorPlane::toString ( ) 
 {
 	ostringstream xml;
- 	xml << "\t<plane id=\"" << m_id << "\" type=\"max operator\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
+	xml.precision(CVCONVNET_XML_PRECISION);
+ 	xml << "\t<plane id=\"" << m_id << "\" type=\"" << gettype() << "\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
 	
 	for (int i=0; i <m_pplane.size(); i++)
 	{
@@ -140,6 +177,33 @@ string CvMaxOperatorPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code computing the feature map of the plane.
+ * \return string containing C++ statements
+ */
+string CvMaxOperatorPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+
+	code << "\t/* " << m_id << ": max operator " << m_fmapsz.width << "x" << m_fmapsz.height << ", neuron " << m_neurosz.width << "x" << m_neurosz.height << " */" << endl;
+	code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t\t{" << endl;
+	code << "\t\t\tsum = -DBL_MAX;" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		string psym = m_pplane[i]->getsymbol();
+		code << "\t\t\tfor (j = 0; j < " << m_neurosz.height << "; j++)" << endl;
+		code << "\t\t\t\tfor (k = 0; k < " << m_neurosz.width << "; k++)" << endl;
+		code << "\t\t\t\t\tif (s->" << psym << "[y*" << m_neurosz.height << "+j][x*" << m_neurosz.width << "+k] > sum)" << endl;
+		code << "\t\t\t\t\t\tsum = s->" << psym << "[y*" << m_neurosz.height << "+j][x*" << m_neurosz.width << "+k];" << endl;
+	}
+	code << "\t\t\ts->" << sym << "[y][x] = sum;" << endl;
+	code << "\t\t}" << endl;
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  */
 int CvMaxOperatorPlane::setweight(std::vector<double> &weights)
@@ -52,11 +52,13 @@ using namespace std;
  * Since max plane is just a data abstraction, feature map and 
  * neuron window size are irrelevant and are not used in the constructor
  * \param id name of the plane
+ * \param minimum nonzero to search for minimum value instead of maximum
  */
-CvMaxPlane::CvMaxPlane (std::string id)
+CvMaxPlane::CvMaxPlane (std::string id, int minimum)
 	: CvGenericPlane(id, cvSize(1,1), cvSize(1,1) ) 
 {
 	m_weight.clear();
+	m_minimum = minimum;
 }
 
 CvMaxPlane::~CvMaxPlane ( ) 
@@ -83,25 +85,53 @@ CvMat * CvMaxPlane::fprop ( )
 		return NULL;
 	}
 
-	// Get the values at parent planes
-	int no_parents = m_pplane.size();
-	m_parentval.resize( no_parents );
-	for (int i = 0; i < no_parents; i++)
+	// Get the values at parent planes, or all outputs of the only parent (dense plane)
+	if (m_pplane.size() == 1 && m_pfmap[0]->cols > 1)
 	{
-		m_parentval[i] = cvmGet( m_pfmap[i], 0, 0 );
+		m_parentval.resize( m_pfmap[0]->cols );
+		for (int i = 0; i < m_parentval.size(); i++)
+			m_parentval[i] = cvmGet( m_pfmap[0], 0, i );
+	} else
+	{
+		m_parentval.resize( m_pplane.size() );
+		for (int i = 0; i < m_parentval.size(); i++)
+			m_parentval[i] = cvmGet( m_pfmap[i], 0, 0 );
 	}
-
-	// Now find the maximum of m_parentval
-	vector<double>::iterator itr = max_element(m_parentval.begin(),m_parentval.end());
+	if (m_minimum)
+	{
+		for (int i = 0; i < m_parentval.size(); i++)
+			m_parentval[i] = -m_parentval[i];
+	}
+	int no_parents = m_parentval.size();
 
 	// The index of maximum is our network's prediction!
-	int pos = distance(m_parentval.begin(), itr);
+	int pos = m_backend->argmax(&m_parentval[0], no_parents);
 
 	cvmSet(m_fmap,0,0,(double) pos );
 
 	return m_fmap;
 }
 
+/*! The output of the max plane is an index, so the confidence is
+ * the value of the parent that won. When searching for minimum
+ * the value is negated, so that larger values still mean more confidence.
+ * \return value of the winning parent
+ */
+double CvMaxPlane::getconfidence ( )
+{
+	if (m_parentval.empty())
+		return 0.0;
+
+	return m_parentval[(int) cvmGet(m_fmap,0,0)];
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvMaxPlane::gettype ( )
+{
+	return "max";
+}
 
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
@@ -114,7 +144,11 @@ CvMat * CvMaxPlane::fprop ( )
 string CvMaxPlane::toString ( ) 
 {
 	ostringstream xml;
- 	xml << "\t<plane id=\"" << m_id << "\" type=\"max\">" << endl;
+	xml.precision(CVCONVNET_XML_PRECISION);
+ 	xml << "\t<plane id=\"" << m_id << "\" type=\"max\"";
+	if (m_minimum)
+		xml << " select=\"min\"";
+	xml << ">" << endl;
 	
 	for (int i=0; i <m_pplane.size(); i++)
 	{
@@ -126,6 +160,46 @@ string CvMaxPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code storing the index of the parent
+ * with the maximum value into the plane.
+ * \return string containing C++ statements
+ */
+string CvMaxPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+
+	code << "\t/* " << m_id << ": " << (m_minimum ? "min" : "max") << " */" << endl;
+	// Candidates are parents' values or all outputs of the only parent
+	vector<string> val;
+	if (m_pplane.size() == 1 && m_pfmap[0]->cols > 1)
+	{
+		for (int i=0; i<m_pfmap[0]->cols; i++)
+		{
+			ostringstream v;
+			v << "s->" << m_pplane[0]->getsymbol() << "[0][" << i << "]";
+			val.push_back(v.str());
+		}
+	} else
+	{
+		for (int i=0; i<m_pplane.size(); i++)
+			val.push_back("s->" + m_pplane[i]->getsymbol() + "[0][0]");
+	}
+
+	code << "\tsum = " << val[0] << ";" << endl;
+	code << "\ts->" << sym << "[0][0] = 0;" << endl;
+	for (int i=1; i<val.size(); i++)
+	{
+		code << "\tif (" << val[i] << " " << (m_minimum ? "<" : ">") << " sum)" << endl;
+		code << "\t{" << endl;
+		code << "\t\tsum = " << val[i] << ";" << endl;
+		code << "\t\ts->" << sym << "[0][0] = " << i << ";" << endl;
+		code << "\t}" << endl;
+	}
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  */
 int CvMaxPlane::setweight(std::vector<double> &weights)
@@ -133,3 +207,12 @@ int CvMaxPlane::setweight(std::vector<double> &weights)
 	// Just dummy function
 	return 1;
 }
+
+/*! Parents of the max plane are the classes it selects from, 
+ * removing one would renumber the rest.
+ * \return always 0
+ */
+int CvMaxPlane::removeparent ( int i )
+{
+	return 0;
+}
@@ -0,0 +1,286 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of OpenCV backend
+ *
+ * Functions of OpenCV work on whole matrices, so most of the primitives
+ * need a temporary matrix to hold the intermediate result. It is kept
+ * between calls, so that forward propagation does not allocate.
+ * \date 2026
+ */
+
+#include "cvopencvbackend.h"
+#include "cvkernels.h"
+#include <cassert>
+#include <float.h>
+
+using namespace std;
+
+//! Scratch matrix and structuring element owned by a thread, released when the thread exits
+struct CvOpenCVScratch
+{
+	CvMat *mat;
+	IplConvKernel *element;
+
+	CvOpenCVScratch ( ) : mat(NULL), element(NULL) { }
+	~CvOpenCVScratch ( ) { cvReleaseMat(&mat); if (element != NULL) cvReleaseStructuringElement(&element); }
+};
+
+//! Scratch of the calling thread
+static thread_local CvOpenCVScratch icvScratch;
+
+string CvOpenCVBackend::getname ( )
+{
+	return "opencv";
+}
+
+/*! The backend is a singleton shared by all networks, which may run
+ * on different threads, so every thread has its own scratch matrix.
+ * The matrix only grows, so it is allocated by the first calls only.
+ * \param rows number of rows of the view
+ * \param cols number of columns of the view
+ * \param view receives the header of the top-left rows x cols region
+ */
+void CvOpenCVBackend::scratch(int rows, int cols, CvMat *view)
+{
+	CvMat *&mat = icvScratch.mat;
+	if (mat == NULL || mat->rows < rows || mat->cols < cols)
+	{
+		int r = (mat == NULL) ? rows : MAX(rows, mat->rows);
+		int c = (mat == NULL) ? cols : MAX(cols, mat->cols);
+
+		cvReleaseMat(&mat);
+		mat = cvCreateMat(r, c, CV_64FC1);
+	}
+
+	cvGetSubRect(mat, view, cvRect(0, 0, cols, rows));
+}
+
+/*! The element of the calling thread is created again only when
+ * the size changes.
+ * \param neurosz size of the element
+ * \return rectangular element anchored at its top-left corner
+ */
+IplConvKernel *CvOpenCVBackend::rectangle(CvSize neurosz)
+{
+	IplConvKernel *&element = icvScratch.element;
+	if (element == NULL || element->nCols != neurosz.width || element->nRows != neurosz.height)
+	{
+		if (element != NULL)
+			cvReleaseStructuringElement(&element);
+		element = cvCreateStructuringElementEx(neurosz.width, neurosz.height, 0, 0, CV_SHAPE_RECT);
+	}
+
+	return element;
+}
+
+/*! The convolution filters the whole parent feature map with the neuron
+ * window anchored at its top-left corner and adds the part where the
+ * window is fully inside the parent.
+ */
+void CvOpenCVBackend::convolve(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows+neurosz.height-1 && src->cols >= acc->cols+neurosz.width-1 );
+
+	CvMat kernel = cvMat(neurosz.height, neurosz.width, CV_64FC1, (void *) weight);
+	CvMat tmp;
+	scratch(src->rows, src->cols, &tmp);
+
+	cvFilter2D(src, &tmp, &kernel, cvPoint(0,0));
+
+	CvMat valid;
+	cvGetSubRect(&tmp, &valid, cvRect(0, 0, acc->cols, acc->rows));
+	cvAdd(acc, &valid, acc);
+}
+
+/*! OpenCV filters have no stride, filtering the whole parent would
+ * compute stride.width*stride.height times more outputs than needed,
+ * so the specialized kernels are used instead.
+ */
+void CvOpenCVBackend::convolvestrided(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvGetStridedConvKernel(neurosz)(src, weight, neurosz, stride, acc);
+}
+
+/*! A filter per plane would read the parent once per plane, 
+ * the blocked kernel reads it once per block of planes.
+ */
+void CvOpenCVBackend::convolvebank(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	icvConvolveBankGeneric(src, weight, n, neurosz, stride, acc);
+}
+
+/*! OpenCV filters work on single channel windows or on channels separately,
+ * neither of them sums over interleaved channels, so the kernel is used.
+ */
+void CvOpenCVBackend::convolvepacked(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolvePackedGeneric(src, weight, channels, neurosz, stride, acc);
+}
+
+void CvOpenCVBackend::combine(const CvMat **src, const double *weight, int n, CvMat *acc)
+{
+	for (int i=0; i<n; i++)
+	{
+		CvMat region;
+		cvGetSubRect(src[i], &region, cvRect(0, 0, acc->cols, acc->rows));
+		cvScaleAdd(&region, cvRealScalar(weight[i]), acc, acc);
+	}
+}
+
+/*! OpenCV has no sparse filter, the kernel is used.
+ */
+void CvOpenCVBackend::convolvesparse(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolveSparseGeneric(src, tap, weight, n, neurosz, stride, acc);
+}
+
+/*! OpenCV filters can't skip zero pixels, the kernel is used.
+ */
+void CvOpenCVBackend::convolvescatter(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	icvConvolveScatterGeneric(src, weight, n, neurosz, stride, acc);
+}
+
+/*! Border outputs are few and need clipped windows, which OpenCV
+ * filters with top-left anchor can not provide, so the kernel is used.
+ */
+void CvOpenCVBackend::convolveclipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc)
+{
+	icvConvolveClipped(src, weight, neurosz, stride, origin, skip, acc);
+}
+
+/*! cvMerge() is limited to four channels.
+ */
+void CvOpenCVBackend::interleave(const CvMat **src, int n, CvMat *dst)
+{
+	icvInterleave(src, n, dst);
+}
+
+/*! Sums are obtained from the window averages computed by area interpolation.
+ */
+void CvOpenCVBackend::sumpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows*neurosz.height && src->cols >= acc->cols*neurosz.width );
+
+	CvMat region;
+	cvGetSubRect(src, &region, cvRect(0, 0, acc->cols*neurosz.width, acc->rows*neurosz.height));
+
+	CvMat tmp;
+	scratch(acc->rows, acc->cols, &tmp);
+	cvResize(&region, &tmp, CV_INTER_AREA);
+	cvScaleAdd(&tmp, cvRealScalar(neurosz.width*neurosz.height), acc, acc);
+}
+
+/*! Window maximums are obtained by dilation with rectangular element
+ * anchored at its top-left corner, every neurosz-th value of the result is taken.
+ */
+void CvOpenCVBackend::maxpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows*neurosz.height && src->cols >= acc->cols*neurosz.width );
+
+	CvMat tmp;
+	scratch(src->rows, src->cols, &tmp);
+
+	cvDilate(src, &tmp, rectangle(neurosz));
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		for (int x=0; x<acc->cols; x++)
+		{
+			double val = CV_MAT_ELEM(tmp, double, y*neurosz.height, x*neurosz.width);
+			if (val > CV_MAT_ELEM(*acc, double, y, x))
+				CV_MAT_ELEM(*acc, double, y, x) = val;
+		}
+	}
+}
+
+double CvOpenCVBackend::dense(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	CvMat window;
+	cvGetSubRect(src, &window, cvRect(0, 0, neurosz.width, neurosz.height));
+
+	CvMat w = cvMat(neurosz.height, neurosz.width, CV_64FC1, (void *) weight);
+
+	return cvDotProduct(&window, &w);
+}
+
+double CvOpenCVBackend::dotsparse(const CvMat *src, const int *index, const double *weight, int n)
+{
+	return icvDotSparseGeneric(src, index, weight, n);
+}
+
+double CvOpenCVBackend::distance(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	CvMat window;
+	cvGetSubRect(src, &window, cvRect(0, 0, neurosz.width, neurosz.height));
+
+	CvMat w = cvMat(neurosz.height, neurosz.width, CV_64FC1, (void *) weight);
+
+	double norm = cvNorm(&window, &w, CV_L2);
+	return norm*norm;
+}
+
+/*! Hyperbolic tangent is computed as 1-2/(exp(2x)+1) with matrix operations.
+ * OpenCV has no counterpart of the fast sigmoid approximation, 
+ * so it is computed by the common kernel.
+ */
+void CvOpenCVBackend::activate(CvMat *fmap, int activation, double scale, double shift)
+{
+	switch (activation)
+	{
+	case CVCONVNET_ACT_TANH:
+		cvConvertScale(fmap, fmap, 2*scale, 2*shift);
+		cvExp(fmap, fmap);
+		cvAddS(fmap, cvRealScalar(1.0), fmap);
+		cvDiv(NULL, fmap, fmap, -2.0);
+		cvAddS(fmap, cvRealScalar(1.0), fmap);
+		break;
+	case CVCONVNET_ACT_IDENTITY:
+		cvConvertScale(fmap, fmap, scale, shift);
+		break;
+	default:
+		icvActivate(fmap, activation, scale, shift);
+	}
+}
+
+int CvOpenCVBackend::argmax(const double *val, int n)
+{
+	CvMat v = cvMat(1, n, CV_64FC1, (void *) val);
+	CvPoint pos;
+
+	cvMinMaxLoc(&v, NULL, NULL, NULL, &pos);
+	return pos.x;
+}
@@ -0,0 +1,257 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of pointwise plane class
+ * \date 2026
+ */
+
+#include "cvpointwiseplane.h"
+#include <cassert>
+#include <sstream>
+
+using namespace std;
+
+/*!
+ * \param id name of the plane
+ * \param fmapsz size of the featuremap for this plane and its parents
+ */
+CvPointwisePlane::CvPointwisePlane (std::string id, CvSize fmapsz)
+	: CvGenericPlane(id, fmapsz, cvSize(1,1))
+{
+	m_weight.resize( 1 );
+
+	m_leader = this;
+	m_group.push_back(this);
+}
+
+CvPointwisePlane::~CvPointwisePlane ( )
+{
+}
+
+/*! The method forward-propagates data from neuron parents to neuron's 
+ * own feature map.
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvPointwisePlane::fprop ( )
+{
+	return fpropregion(cvRect(0, 0, m_fmapsz.width, m_fmapsz.height));
+}
+
+/*! The method recomputes a region of plane's feature map,
+ * every output depends on the same position of the parents only.
+ * The leader of a group recomputes the region of all planes of the group,
+ * row by row, so that each row of the parents is read once.
+ * \param rect region of the feature map to be recomputed
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvPointwisePlane::fpropregion ( CvRect rect )
+{
+	assert( m_connected );
+	assert( rect.x >= 0 && rect.y >= 0 && rect.x+rect.width <= m_fmapsz.width && rect.y+rect.height <= m_fmapsz.height );
+
+	// Computed by the leader of the group
+	if (m_leader != this)
+		return m_fmap;
+
+	vector<CvMat> region(m_group.size());
+	for (int g=0; g<m_group.size(); g++)
+	{
+		cvGetSubRect(m_group[g]->m_fmap, &region[g], rect);
+		cvSet(&region[g], cvRealScalar(m_group[g]->m_weight[0]));
+	}
+
+	// A single plane combines the whole region at once
+	int rows = (m_group.size() > 1) ? 1 : rect.height;
+	vector<CvMat> prow(m_pfmap.size());
+	vector<const CvMat *> psrc(m_pfmap.size());
+	for (int y=0; y<rect.height && !psrc.empty(); y+=rows)
+	{
+		for (int i=0; i<m_pfmap.size(); i++)
+		{
+			cvGetSubRect(m_pfmap[i], &prow[i], cvRect(rect.x, rect.y+y, rect.width, rows));
+			psrc[i] = &prow[i];
+		}
+
+		for (int g=0; g<m_group.size(); g++)
+		{
+			CvMat row;
+			cvGetSubRect(&region[g], &row, cvRect(0, y, rect.width, rows));
+			m_backend->combine(&psrc[0], &m_group[g]->m_weight[1], psrc.size(), &row);
+		}
+	}
+
+	for (int g=0; g<m_group.size(); g++)
+		m_backend->activate(&region[g], CVCONVNET_ACT_TANH, 1.0, 0.0);
+
+	return m_fmap;
+}
+
+/*! The plane becomes the leader of the group and computes all its planes
+ * in its own fprop() and fpropregion(). Only planes with the same parents
+ * and feature map size can form a group, and the leader must be the first
+ * of them to be computed by the network.
+ * \param group planes of the group, the first one must be this plane
+ * \return status of operation
+ */
+int CvPointwisePlane::share ( std::vector<CvPointwisePlane *> &group )
+{
+	if (!m_connected || group.empty() || group[0] != this || m_leader != this || m_group.size() != 1)
+		return 0;
+
+	for (int g=1; g<group.size(); g++)
+	{
+		CvPointwisePlane *p = group[g];
+		if (!p->m_connected || p->m_leader != p || p->m_group.size() != 1 || p->m_pplane != m_pplane
+			|| p->m_fmapsz.width != m_fmapsz.width || p->m_fmapsz.height != m_fmapsz.height)
+			return 0;
+	}
+
+	for (int g=0; g<group.size(); g++)
+	{
+		group[g]->m_leader = this;
+		group[g]->m_group.clear();
+	}
+	m_group = group;
+
+	return 1;
+}
+
+/*!
+ * \param prect changed region of a parent's feature map
+ * \return the same region clipped by the feature map (may be empty)
+ */
+CvRect CvPointwisePlane::getdirtyrect ( CvRect prect )
+{
+	int x0 = MAX(prect.x, 0);
+	int y0 = MAX(prect.y, 0);
+	int x1 = MIN(prect.x+prect.width, m_fmapsz.width);
+	int y1 = MIN(prect.y+prect.height, m_fmapsz.height);
+
+	if (x1 <= x0 || y1 <= y0)
+		return cvRect(0,0,0,0);
+
+	return cvRect(x0, y0, x1-x0, y1-y0);
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvPointwisePlane::gettype ( )
+{
+	return "pointwise";
+}
+
+/*! The method produces an XML representation of the plane,
+ * each connection holds a single weight.
+ * \return string containing XML description of the plane
+ */
+string CvPointwisePlane::toString ( )
+{
+	ostringstream xml;
+	xml.precision(CVCONVNET_XML_PRECISION);
+	xml << "\t<plane id=\"" << m_id << "\" type=\"pointwise\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\">" << endl;
+	xml << "\t\t<bias> " << m_weight[0] << " </bias>" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		xml << "\t\t<connection to=\"" << m_pplane[i]->getid() << "\"> " << m_weight[i+1] << " </connection>" << endl;
+	}
+	xml << "\t</plane>" << endl;
+
+	return xml.str();
+}
+
+/*! The method produces C++ code computing the feature map of the plane.
+ * \return string containing C++ statements
+ */
+string CvPointwisePlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+
+	code << "\t/* " << m_id << ": pointwise " << m_fmapsz.width << "x" << m_fmapsz.height << ", " << m_pplane.size() << " parents */" << endl;
+	code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t\t{" << endl;
+	code << "\t\t\tsum = " << sym << "_w[0];" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		code << "\t\t\tsum += " << sym << "_w[" << i+1 << "]*s->" << m_pplane[i]->getsymbol() << "[y][x];" << endl;
+	}
+	code << "\t\t\ts->" << sym << "[y][x] = tanh(sum);" << endl;
+	code << "\t\t}" << endl;
+
+	return code.str();
+}
+
+/*! Parents must have the size of plane's feature map,
+ * the weights are the bias followed by one weight per parent.
+ * \param weights vector of weights to be set
+ * \return status of operation
+ */
+int CvPointwisePlane::setweight(std::vector<double> &weights)
+{
+	if (weights.size() != m_pplane.size()+1)
+		return 0;
+
+	for (int i=0; i<m_pfmap.size(); i++)
+	{
+		if (m_pfmap[i]->cols != m_fmapsz.width || m_pfmap[i]->rows != m_fmapsz.height)
+			return 0;
+	}
+
+	return CvGenericPlane::setweight(weights);
+}
+
+/*! Weights of parents (not the bias) of small magnitude are set to zero.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvPointwisePlane::prune ( double threshold )
+{
+	return pruneweights(threshold, 1);
+}
+
+/*! The weight of the parent is removed.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvPointwisePlane::removeparent ( int i )
+{
+	if (m_weight.size() != m_pplane.size()+1 || !CvGenericPlane::removeparent(i))
+		return 0;
+
+	m_weight.erase(m_weight.begin()+1+i);
+	return 1;
+}
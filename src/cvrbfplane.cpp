@@ -32,18 +32,15 @@ All information provided related to future Intel products and plans is
 preliminary and subject to change at any time, without notice.
 *****************************************************************************/
 /*!\file
- * \brief Implementation of RBF plane class [NOT FINISHED!]
- * 
- * The class has never been tested yet and is not recommended to use at this moment
- * RBF planes should be tested first.
+ * \brief Implementation of RBF plane class
  * \author Akhmed Umyarov
  * \date 2007
  */
 
 #include "cvrbfplane.h"
-#include "cvfastsigmoid.h"
 #include <iostream>
 #include <sstream>
+#include <cstring>
 
 using namespace std;
 
@@ -64,10 +61,15 @@ CvRBFPlane::CvRBFPlane  (std::string id, CvSize fmapsz, CvSize neurosz)
 	// Init weights for the neuron of RBF plane
 	m_weight.resize( neurosz.height*neurosz.width );
 
+	m_leader = this;
+	m_stale = 1;
+	m_x = NULL;
 }
 
 CvRBFPlane::~CvRBFPlane ( ) 
 { 
+	if (m_x)
+		cvReleaseMat(&m_x);
 }
 
 //  
@@ -91,40 +93,118 @@ CvMat * CvRBFPlane::fprop ()
 		return NULL;
 	}
 
+	// Computed by the leader of the group
+	if (m_leader != this)
+		return m_fmap;
+
+	if (m_group.size() > 1)
+	{
+		fpropgroup();
+		return m_fmap;
+	}
+
+	int windowsz = m_neurosz.height*m_neurosz.width;
 	for (int y=0; y<m_fmapsz.height; y++)
 	{
 		for (int x=0; x<m_fmapsz.width; x++)
 		{
-	
 			double sum = 0.0; 
-			int w = 0;
 			for (int i = 0; i < m_pplane.size(); i++)
 			{
-				CvMat *fmap = m_pfmap[i];
-				assert( cvGetSize(fmap).height >= y+m_neurosz.height
-					&& cvGetSize(fmap).width >= x+m_neurosz.width );
-				
-				for (int j=0; j<m_neurosz.height; j++)
-				{
-					for (int k=0; k<m_neurosz.width; k++)
-					{
-						double dist = (m_weight[w++]-cvmGet(fmap, y+j, x+k));
-						sum += dist*dist;
-					}
-				}
+				CvMat window;
+				cvGetSubRect(m_pfmap[i], &window, cvRect(x, y, m_neurosz.width, m_neurosz.height));
+				sum += m_backend->distance(&window, &m_weight[i*windowsz], m_neurosz);
 			}
 
-			// Sigmoid
-			double val = DQstdsigmoid(sum);
-
-			// Update the value at feature map
-			cvmSet(m_fmap,y,x,val);
+			cvmSet(m_fmap,y,x,sum);
 		}
 	}
 
 	return m_fmap;
 }
 
+/*! The leader gathers neuron windows of the parents into one row x
+ * and gets every distance of the group from ||x||^2 and a dot product.
+ * Rounding may make the expanded distance slightly negative, 
+ * such values are clamped to zero.
+ */
+void CvRBFPlane::fpropgroup ( )
+{
+	int windowsz = m_neurosz.height*m_neurosz.width;
+	CvSize rowsz = cvSize(m_x->cols, 1);
+
+	if (m_stale)
+	{
+		m_norm.resize(m_group.size());
+		for (int g=0; g<m_group.size(); g++)
+		{
+			CvMat w = cvMat(1, rowsz.width, CV_64FC1, &m_group[g]->m_weight[0]);
+			m_norm[g] = m_backend->dense(&w, &m_group[g]->m_weight[0], rowsz);
+		}
+		m_stale = 0;
+	}
+
+	double *x = m_x->data.db;
+	for (int i=0; i<m_pfmap.size(); i++)
+	{
+		for (int j=0; j<m_neurosz.height; j++)
+		{
+			memcpy(x, m_pfmap[i]->data.ptr + (size_t)m_pfmap[i]->step*j, m_neurosz.width*sizeof(double));
+			x += m_neurosz.width;
+		}
+	}
+
+	double xx = m_backend->dense(m_x, m_x->data.db, rowsz);
+	for (int g=0; g<m_group.size(); g++)
+	{
+		double dist = xx - 2*m_backend->dense(m_x, &m_group[g]->m_weight[0], rowsz) + m_norm[g];
+		cvmSet(m_group[g]->m_fmap, 0, 0, MAX(dist, 0.0));
+	}
+}
+
+/*! The plane becomes the leader of the group and computes distances 
+ * of all its planes in its own fprop. Only output planes (1x1 feature map)
+ * with the same parents and neuron window can form a group, and the leader
+ * must be the first of them to be computed by the network.
+ * \param group planes of the group, the first one must be this plane
+ * \return status of operation
+ */
+int CvRBFPlane::share ( std::vector<CvRBFPlane *> &group )
+{
+	if (!m_connected || group.empty() || group[0] != this || m_fmapsz.width != 1 || m_fmapsz.height != 1)
+		return 0;
+
+	for (int g=1; g<group.size(); g++)
+	{
+		if (group[g]->m_pplane != m_pplane || group[g]->m_neurosz.width != m_neurosz.width 
+			|| group[g]->m_neurosz.height != m_neurosz.height
+			|| group[g]->m_fmapsz.width != 1 || group[g]->m_fmapsz.height != 1)
+			return 0;
+	}
+
+	for (int g=0; g<group.size(); g++)
+	{
+		group[g]->m_leader = this;
+		group[g]->m_group.clear();
+	}
+	m_group = group;
+	m_stale = 1;
+
+	if (m_x)
+		cvReleaseMat(&m_x);
+	m_x = cvCreateMat(1, m_pplane.size()*m_neurosz.height*m_neurosz.width, CV_64FC1);
+
+	return 1;
+}
+
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvRBFPlane::gettype ( )
+{
+	return "rbf";
+}
 
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
@@ -137,6 +217,7 @@ CvMat * CvRBFPlane::fprop ()
 string CvRBFPlane::toString ( ) 
 {
 	ostringstream xml;
+	xml.precision(CVCONVNET_XML_PRECISION);
  	xml << "\t<plane id=\"" << m_id << "\" type=\"rbf\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
 
 	int windowsz = m_neurosz.height*m_neurosz.width;
@@ -156,6 +237,35 @@ string CvRBFPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code computing the feature map of the plane.
+ * \return string containing C++ statements
+ */
+string CvRBFPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+
+	code << "\t/* " << m_id << ": rbf " << m_fmapsz.width << "x" << m_fmapsz.height << ", neuron " << m_neurosz.width << "x" << m_neurosz.height << " */" << endl;
+	code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t\t{" << endl;
+	code << "\t\t\tsum = 0;" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		code << "\t\t\tfor (j = 0; j < " << m_neurosz.height << "; j++)" << endl;
+		code << "\t\t\t\tfor (k = 0; k < " << m_neurosz.width << "; k++)" << endl;
+		code << "\t\t\t\t{" << endl;
+		code << "\t\t\t\t\tdouble dist = " << sym << "_w[" << i*windowsz << " + j*" << m_neurosz.width << " + k] - s->" << m_pplane[i]->getsymbol() << "[y+j][x+k];" << endl;
+		code << "\t\t\t\t\tsum += dist*dist;" << endl;
+		code << "\t\t\t\t}" << endl;
+	}
+	code << "\t\t\ts->" << sym << "[y][x] = sum;" << endl;
+	code << "\t\t}" << endl;
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  */
 int CvRBFPlane::setweight(std::vector<double> &weights)
@@ -164,5 +274,22 @@ int CvRBFPlane::setweight(std::vector<double> &weights)
 	if (weights.size() != m_neurosz.width*m_neurosz.height*m_pplane.size())
 		return 0;
 
+	// Norms of the group are recomputed by the next fprop
+	m_leader->m_stale = 1;
+
 	return CvGenericPlane::setweight(weights);
 }
+
+/*! The window of the parent is removed from the weights.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvRBFPlane::removeparent ( int i )
+{
+	int windowsz = m_neurosz.width*m_neurosz.height;
+	if (m_weight.size() != m_pplane.size()*windowsz || !CvGenericPlane::removeparent(i))
+		return 0;
+
+	m_weight.erase(m_weight.begin()+i*windowsz, m_weight.begin()+(i+1)*windowsz);
+	return 1;
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of reference backend
+ * \date 2026
+ */
+
+#include "cvreferencebackend.h"
+#include "cvkernels.h"
+
+using namespace std;
+
+string CvReferenceBackend::getname ( )
+{
+	return "reference";
+}
+
+void CvReferenceBackend::convolve(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	icvConvolveGeneric(src, weight, neurosz, acc);
+}
+
+void CvReferenceBackend::convolvestrided(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolveStridedGeneric(src, weight, neurosz, stride, acc);
+}
+
+/*! Planes are convolved one after another, the bank kernels of other
+ * backends are checked against this.
+ */
+void CvReferenceBackend::convolvebank(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	for (int i=0; i<n; i++)
+		icvConvolveStridedGeneric(src, weight[i], neurosz, stride, acc[i]);
+}
+
+void CvReferenceBackend::convolvepacked(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolvePackedGeneric(src, weight, channels, neurosz, stride, acc);
+}
+
+void CvReferenceBackend::convolvesparse(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolveSparseGeneric(src, tap, weight, n, neurosz, stride, acc);
+}
+
+void CvReferenceBackend::convolvescatter(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	icvConvolveScatterGeneric(src, weight, n, neurosz, stride, acc);
+}
+
+void CvReferenceBackend::convolveclipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc)
+{
+	icvConvolveClipped(src, weight, neurosz, stride, origin, skip, acc);
+}
+
+void CvReferenceBackend::combine(const CvMat **src, const double *weight, int n, CvMat *acc)
+{
+	icvCombineGeneric(src, weight, n, acc);
+}
+
+void CvReferenceBackend::interleave(const CvMat **src, int n, CvMat *dst)
+{
+	icvInterleave(src, n, dst);
+}
+
+void CvReferenceBackend::sumpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	icvSumPoolGeneric(src, neurosz, acc);
+}
+
+void CvReferenceBackend::maxpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	icvMaxPoolGeneric(src, neurosz, acc);
+}
+
+double CvReferenceBackend::dense(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	return icvDotGeneric(src, weight, neurosz);
+}
+
+double CvReferenceBackend::dotsparse(const CvMat *src, const int *index, const double *weight, int n)
+{
+	return icvDotSparseGeneric(src, index, weight, n);
+}
+
+double CvReferenceBackend::distance(const CvMat *src, const double *weight, CvSize neurosz)
+{
+	return icvDistGeneric(src, weight, neurosz);
+}
+
+void CvReferenceBackend::activate(CvMat *fmap, int activation, double scale, double shift)
+{
+	icvActivate(fmap, activation, scale, shift);
+}
+
+int CvReferenceBackend::argmax(const double *val, int n)
+{
+	return icvArgmax(val, n);
+}
@@ -39,6 +39,7 @@ preliminary and subject to change at any time, without notice.
  */
 
 #include "cvregressionplane.h"
+#include "cvdenseplane.h"
 #include "cvfastsigmoid.h"
 #include <iostream>
 #include <sstream>
@@ -65,10 +66,16 @@ CvRegressionPlane::CvRegressionPlane  (std::string id, CvSize neurosz)
 {
  	// Init weights for the neuron of regression plane
  	m_weight.resize(neurosz.height * neurosz.width + 1);
+
+	m_leader = this;
+	m_dense = NULL;
+	m_output = 0;
 }
 
 CvRegressionPlane::~CvRegressionPlane ( ) 
 { 
+	if (m_leader == this)
+		delete m_dense;
 }
 
 //  
@@ -83,25 +90,51 @@ CvRegressionPlane::~CvRegressionPlane ( )
 CvMat* CvRegressionPlane::fprop()
 {
     assert( m_connected );
+
+    // A view of the dense plane computed by the leader
+    if (m_dense != NULL)
+    {
+        if (m_leader == this)
+        {
+            m_dense->setbackend(m_backend);
+            m_dense->fprop();
+        }
+        cvmSet(m_fmap, 0, 0, cvmGet(m_dense->getfmap(), 0, m_output));
+        return m_fmap;
+    }
+
     // Start with the bias
-    int w_index = 0;
-    double sum = m_weight[w_index];
+    int windowsz = m_neurosz.height * m_neurosz.width;
+    double sum = m_weight[0];
     for (int pfmap_index = 0; pfmap_index < m_pplane.size(); pfmap_index++)
     {
-        CvMat *fmap = m_pfmap[pfmap_index];
-        for (int row = 0; row < m_neurosz.height; row++)
-        {
-            for (int col = 0; col < m_neurosz.width; col++)
-            {
-               sum += m_weight[++w_index] * cvmGet(fmap, row, col);
-            } // for col
-        } // for row
+        sum += m_backend->dense(m_pfmap[pfmap_index],
+                                &m_weight[1 + pfmap_index * windowsz],
+                                m_neurosz);
     } // for pfmap_index
     cvmSet(m_fmap, 0, 0, sum);
     return m_fmap;
 } // CvRegressionPlane::fprop()
 
 
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvRegressionPlane::gettype ( )
+{
+    return "regression";
+}
+
+/*! The leader of a group has the form of its dense plane.
+ * \return description of the form
+ */
+string CvRegressionPlane::getform ( )
+{
+    if (m_dense != NULL && m_leader == this)
+        return m_dense->getform();
+    return "";
+}
+
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
  * parents.
@@ -113,6 +146,7 @@ CvMat* CvRegressionPlane::fprop()
 string CvRegressionPlane::toString ( ) 
 {
 	ostringstream xml;
+	xml.precision(CVCONVNET_XML_PRECISION);
  	xml << "\t<plane id=\"" << m_id << "\" type=\"regression\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
 
 	int windowsz = m_neurosz.height*m_neurosz.width;
@@ -134,6 +168,28 @@ string CvRegressionPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code computing the output of the plane.
+ * \return string containing C++ statements
+ */
+string CvRegressionPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+	int windowsz = m_neurosz.height*m_neurosz.width;
+
+	code << "\t/* " << m_id << ": regression, neuron " << m_neurosz.width << "x" << m_neurosz.height << " */" << endl;
+	code << "\tsum = " << sym << "_w[0];" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		code << "\tfor (j = 0; j < " << m_neurosz.height << "; j++)" << endl;
+		code << "\t\tfor (k = 0; k < " << m_neurosz.width << "; k++)" << endl;
+		code << "\t\t\tsum += " << sym << "_w[" << i*windowsz+1 << " + j*" << m_neurosz.width << " + k]*s->" << m_pplane[i]->getsymbol() << "[j][k];" << endl;
+	}
+	code << "\ts->" << sym << "[0][0] = sum;" << endl;
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  * connto() should be invoked BEFORE any attempt to set weights
  * since weights have meaning only when connected
@@ -147,5 +203,74 @@ int CvRegressionPlane::setweight(std::vector<double> &weights)
 	if (weights.size() != (m_neurosz.width*m_neurosz.height*m_pplane.size()+1))
 		return 0;
 
+	if (m_dense != NULL && !m_dense->setrow(m_output, weights))
+		return 0;
+
 	return CvGenericPlane::setweight(weights);
 }
+
+/*! Weights of parents (not the bias) of small magnitude are set to zero,
+ * the dense plane of the group gets them as well.
+ * \param threshold magnitude of the smallest weight to keep
+ * \return number of weights set to zero
+ */
+int CvRegressionPlane::prune ( double threshold )
+{
+	return pruneweights(threshold, 1);
+}
+
+/*! The window of the parent is removed from the weights.
+ * \param i index of the parent
+ * \return status of operation
+ */
+int CvRegressionPlane::removeparent ( int i )
+{
+	int windowsz = m_neurosz.width*m_neurosz.height;
+	if (m_weight.size() != m_pplane.size()*windowsz+1 || !CvGenericPlane::removeparent(i))
+		return 0;
+
+	m_weight.erase(m_weight.begin()+1+i*windowsz, m_weight.begin()+1+(i+1)*windowsz);
+	return 1;
+}
+
+/*! The plane becomes the leader of the group: it creates a dense plane
+ * with one output per plane of the group, connected to the same parents,
+ * and computes it in its fprop. Other planes of the group just copy 
+ * their output, so they must be computed after the leader.
+ * \param group planes of the group, the first one must be this plane
+ * \return status of operation
+ */
+int CvRegressionPlane::share ( std::vector<CvRegressionPlane *> &group )
+{
+    if (!m_connected || group.empty() || group[0] != this || m_dense != NULL)
+        return 0;
+
+    for (int g = 1; g < group.size(); g++)
+    {
+        if (group[g]->m_pplane != m_pplane || group[g]->m_dense != NULL
+            || group[g]->m_neurosz.width != m_neurosz.width
+            || group[g]->m_neurosz.height != m_neurosz.height)
+            return 0;
+    } // for g
+
+    // The dense plane is not part of the network, parents don't know it
+    CvDensePlane *dense = new CvDensePlane(m_id+"_dense", group.size(), m_neurosz);
+    dense->connhidden(m_pplane);
+    for (int g = 0; g < group.size(); g++)
+    {
+        if (!dense->setrow(g, group[g]->m_weight))
+        {
+            delete dense;
+            return 0;
+        }
+    } // for g
+
+    for (int g = 0; g < group.size(); g++)
+    {
+        group[g]->m_leader = this;
+        group[g]->m_dense = dense;
+        group[g]->m_output = g;
+    } // for g
+
+    return 1;
+} // CvRegressionPlane::share()
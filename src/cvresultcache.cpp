@@ -0,0 +1,212 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of result cache class
+ * \date 2026
+ */
+
+#include <cassert>
+#include <cstring>
+#include "cvresultcache.h"
+
+using namespace std;
+
+/*!
+ * \param capacity maximum number of results kept in the cache
+ */
+CvResultCache::CvResultCache ( int capacity )
+{
+	assert( capacity > 0 );
+
+	m_capacity = capacity;
+	m_hits = 0;
+	m_misses = 0;
+}
+
+CvResultCache::~CvResultCache ( )
+{
+	clear();
+}
+
+/*! A successful lookup makes the entry the most recently used one.
+ * An entry of the same key stored for a different input is a miss.
+ * \param key hash of the input
+ * \param input source plane's feature map
+ * \param value receives the cached result
+ * \param planeidx receives index of the plane that produced the result
+ * \return 1 if the key was found, 0 otherwise
+ */
+int CvResultCache::lookup ( uint64 key, const CvMat *input, double &value, int &planeidx )
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	map<uint64, list<CvResultCacheEntry>::iterator>::iterator itr = m_index.find(key);
+	if (itr == m_index.end() || !isequal(itr->second->input, input))
+	{
+		m_misses++;
+		return 0;
+	}
+
+	m_lru.splice(m_lru.begin(), m_lru, itr->second);
+	value = itr->second->value;
+	planeidx = itr->second->planeidx;
+	m_hits++;
+	return 1;
+}
+
+/*! If the cache is full, the least recently used entry is dropped.
+ * An entry of the same key is replaced.
+ * \param key hash of the input
+ * \param input source plane's feature map, the cache keeps a copy
+ * \param value result of fprop
+ * \param planeidx index of the plane that produced the result
+ */
+void CvResultCache::store ( uint64 key, const CvMat *input, double value, int planeidx )
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	CvResultCacheEntry entry = { key, cvCloneMat(input), value, planeidx };
+
+	map<uint64, list<CvResultCacheEntry>::iterator>::iterator itr = m_index.find(key);
+	if (itr != m_index.end())
+	{
+		// Another thread might have stored it meanwhile, or it is a collision
+		cvReleaseMat(&itr->second->input);
+		*itr->second = entry;
+		m_lru.splice(m_lru.begin(), m_lru, itr->second);
+		return;
+	}
+
+	if (m_lru.size() >= m_capacity)
+	{
+		m_index.erase(m_lru.back().key);
+		cvReleaseMat(&m_lru.back().input);
+		m_lru.pop_back();
+	}
+
+	m_lru.push_front(entry);
+	m_index[key] = m_lru.begin();
+}
+
+void CvResultCache::clear ( )
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	for (list<CvResultCacheEntry>::iterator itr = m_lru.begin(); itr != m_lru.end(); itr++)
+		cvReleaseMat(&itr->input);
+	m_lru.clear();
+	m_index.clear();
+	m_hits = 0;
+	m_misses = 0;
+}
+
+/*!
+ * \return number of successful lookups since construction or clear()
+ */
+long CvResultCache::gethits ( )
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_hits;
+}
+
+/*!
+ * \return number of failed lookups since construction or clear()
+ */
+long CvResultCache::getmisses ( )
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_misses;
+}
+
+/*!
+ * \return fraction of successful lookups (0 if there were none)
+ */
+double CvResultCache::gethitrate ( )
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (m_hits+m_misses == 0)
+		return 0.0;
+
+	return (double) m_hits/(m_hits+m_misses);
+}
+
+/*! The function computes a 64-bit FNV-1a style hash of feature map values,
+ * taking whole values instead of single bytes and folding
+ * the high half of the state into the low one after every value. Feature map size is
+ * hashed as well.
+ * \param fmap CV_64FC1 feature map
+ * \return hash of the feature map
+ */
+uint64 CvResultCache::hash ( const CvMat *fmap )
+{
+	const uint64 prime = 1099511628211ULL;
+	uint64 h = 14695981039346656037ULL;
+
+	h = (h ^ (uint64) fmap->rows) * prime;
+	h = (h ^ (uint64) fmap->cols) * prime;
+
+	for (int y = 0; y < fmap->rows; y++)
+	{
+		const uint64 *row = (const uint64 *)(fmap->data.ptr + (size_t)fmap->step*y);
+
+		for (int x = 0; x < fmap->cols; x++)
+		{
+			h = (h ^ row[x]) * prime;
+			h ^= h >> 32; // Let high bits of values affect low bits of hash
+		}
+	}
+
+	return h;
+}
+
+/*! Values are compared bit by bit, like they are hashed by hash().
+ * \param a CV_64FC1 feature map
+ * \param b CV_64FC1 feature map
+ * \return 1 if the maps are of the same size and values, 0 otherwise
+ */
+int CvResultCache::isequal ( const CvMat *a, const CvMat *b )
+{
+	if (a->rows != b->rows || a->cols != b->cols)
+		return 0;
+
+	for (int y = 0; y < a->rows; y++)
+	{
+		if (memcmp(a->data.ptr + (size_t)a->step*y, b->data.ptr + (size_t)b->step*y, a->cols*sizeof(double)) != 0)
+			return 0;
+	}
+
+	return 1;
+}
@@ -0,0 +1,482 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Implementation of hand-vectorized backend
+ *
+ * Convolution computes two neighbouring outputs at once in an SSE2
+ * register. Every output still receives the products in the same order
+ * as in the reference backend, so convolutions give identical results.
+ * Packed convolution, dense() and distance() sum in pairs of partial
+ * sums, so their results differ from the reference in the last bits.
+ * \date 2026
+ */
+
+#include "cvsimdbackend.h"
+#include "cvkernels.h"
+#include <cassert>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+//! Pointer to the beginning of the row of CV_64FC1 matrix
+#define ICV_ROW(mat,y) ((double *)((mat)->data.ptr + (size_t)(mat)->step*(y)))
+
+#ifdef __SSE2__
+
+//! Vectorized convolution with the window size known at compile time
+template <int KH, int KW>
+static void icvConvolveSSE2(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	assert( neurosz.height == KH && neurosz.width == KW );
+	assert( src->rows >= acc->rows+KH-1 && src->cols >= acc->cols+KW-1 );
+
+	__m128d w[KH*KW];
+	for (int i=0; i<KH*KW; i++)
+		w[i] = _mm_set1_pd(weight[i]);
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		const double *s[KH];
+		for (int j=0; j<KH; j++)
+			s[j] = ICV_ROW(src,y+j);
+
+		double *dst = ICV_ROW(acc,y);
+		int x = 0;
+		for (; x+1<acc->cols; x+=2)
+		{
+			__m128d sum = _mm_loadu_pd(dst+x);
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					sum = _mm_add_pd(sum, _mm_mul_pd(w[j*KW+k], _mm_loadu_pd(s[j]+x+k)));
+			_mm_storeu_pd(dst+x, sum);
+		}
+		for (; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			for (int j=0; j<KH; j++)
+				for (int k=0; k<KW; k++)
+					sum += weight[j*KW+k]*s[j][x+k];
+			dst[x] = sum;
+		}
+	}
+}
+
+//! Vectorized convolution for any neuron window
+static void icvConvolveSSE2Generic(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+	assert( src->rows >= acc->rows+neurosz.height-1 && src->cols >= acc->cols+neurosz.width-1 );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		int x = 0;
+		for (; x+1<acc->cols; x+=2)
+		{
+			__m128d sum = _mm_loadu_pd(dst+x);
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y+j)+x;
+				for (int k=0; k<neurosz.width; k++)
+					sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(*w++), _mm_loadu_pd(s+k)));
+			}
+			_mm_storeu_pd(dst+x, sum);
+		}
+		for (; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y+j)+x;
+				for (int k=0; k<neurosz.width; k++)
+					sum += (*w++)*s[k];
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+//! Vectorized strided convolution for any neuron window
+/*! Inputs of two neighbouring outputs are stride.width apart, 
+ * so they are gathered into one register by two half loads.
+ */
+static void icvConvolveStridedSSE2(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	assert( src->rows >= (acc->rows-1)*stride.height+neurosz.height && src->cols >= (acc->cols-1)*stride.width+neurosz.width );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		int x = 0;
+		for (; x+1<acc->cols; x+=2)
+		{
+			__m128d sum = _mm_loadu_pd(dst+x);
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s0 = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+				const double *s1 = s0+stride.width;
+				for (int k=0; k<neurosz.width; k++)
+				{
+					__m128d s = _mm_loadh_pd(_mm_load_sd(s0+k), s1+k);
+					sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(*w++), s));
+				}
+			}
+			_mm_storeu_pd(dst+x, sum);
+		}
+		for (; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+				for (int k=0; k<neurosz.width; k++)
+					sum += (*w++)*s[k];
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+/*! One row of outputs of B planes, two neighbouring outputs of every plane
+ * are held in one register. A pair of source values is loaded once per
+ * window element and multiplied by the weights of all B planes, so 
+ * B up to 8 fits the sixteen SSE registers.
+ */
+template <int B>
+static void icvConvolveBankRowSSE2(const CvMat *src, const double **weight, CvSize neurosz, CvSize stride, CvMat **acc, int y)
+{
+	double *dst[B];
+	for (int b=0; b<B; b++)
+		dst[b] = ICV_ROW(acc[b],y);
+
+	int x = 0;
+	for (; x+1<acc[0]->cols; x+=2)
+	{
+		__m128d sum[B];
+		for (int b=0; b<B; b++)
+			sum[b] = _mm_loadu_pd(dst[b]+x);
+
+		int widx = 0;
+		for (int j=0; j<neurosz.height; j++)
+		{
+			const double *s0 = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+			const double *s1 = s0+stride.width;
+			for (int k=0; k<neurosz.width; k++, widx++)
+			{
+				__m128d s = _mm_loadh_pd(_mm_load_sd(s0+k), s1+k);
+				for (int b=0; b<B; b++)
+					sum[b] = _mm_add_pd(sum[b], _mm_mul_pd(_mm_set1_pd(weight[b][widx]), s));
+			}
+		}
+
+		for (int b=0; b<B; b++)
+			_mm_storeu_pd(dst[b]+x, sum[b]);
+	}
+	for (; x<acc[0]->cols; x++)
+	{
+		for (int b=0; b<B; b++)
+		{
+			double sum = dst[b][x];
+			const double *w = weight[b];
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*stride.height+j)+x*stride.width;
+				for (int k=0; k<neurosz.width; k++)
+					sum += (*w++)*s[k];
+			}
+			dst[b][x] = sum;
+		}
+	}
+}
+
+/*! Window rows of all channels are contiguous, so they are read two
+ * values at a time for two neighbouring outputs, the pairs of partial
+ * sums are added horizontally at the end.
+ */
+static void icvConvolvePackedSSE2(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	int len = neurosz.width*channels;
+	int step = stride.width*channels;
+	assert( src->rows >= (acc->rows-1)*stride.height+neurosz.height && src->cols >= ((acc->cols-1)*stride.width+neurosz.width)*channels );
+
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		int x = 0;
+		for (; x+1<acc->cols; x+=2)
+		{
+			__m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+			double tail0 = dst[x], tail1 = dst[x+1];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++, w+=len)
+			{
+				const double *s0 = ICV_ROW(src,y*stride.height+j)+x*step;
+				const double *s1 = s0+step;
+				int t = 0;
+				for (; t+1<len; t+=2)
+				{
+					__m128d w2 = _mm_loadu_pd(w+t);
+					sum0 = _mm_add_pd(sum0, _mm_mul_pd(w2, _mm_loadu_pd(s0+t)));
+					sum1 = _mm_add_pd(sum1, _mm_mul_pd(w2, _mm_loadu_pd(s1+t)));
+				}
+				if (t < len)
+				{
+					tail0 += w[t]*s0[t];
+					tail1 += w[t]*s1[t];
+				}
+			}
+			__m128d lo = _mm_unpacklo_pd(sum0, sum1);
+			__m128d hi = _mm_unpackhi_pd(sum0, sum1);
+			_mm_storeu_pd(dst+x, _mm_add_pd(_mm_set_pd(tail1, tail0), _mm_add_pd(lo, hi)));
+		}
+		for (; x<acc->cols; x++)
+		{
+			double sum = dst[x];
+			const double *w = weight;
+			for (int j=0; j<neurosz.height; j++)
+			{
+				const double *s = ICV_ROW(src,y*stride.height+j)+x*step;
+				for (int t=0; t<len; t++)
+					sum += (*w++)*s[t];
+			}
+			dst[x] = sum;
+		}
+	}
+}
+
+#endif // __SSE2__
+
+string CvSIMDBackend::getname ( )
+{
+	return "simd";
+}
+
+void CvSIMDBackend::convolve(const CvMat *src, const double *weight, CvSize neurosz, CvMat *acc)
+{
+#ifdef __SSE2__
+	if (neurosz.height == 3 && neurosz.width == 3)
+		icvConvolveSSE2<3,3>(src, weight, neurosz, acc);
+	else if (neurosz.height == 5 && neurosz.width == 5)
+		icvConvolveSSE2<5,5>(src, weight, neurosz, acc);
+	else if (neurosz.height == 7 && neurosz.width == 7)
+		icvConvolveSSE2<7,7>(src, weight, neurosz, acc);
+	else
+		icvConvolveSSE2Generic(src, weight, neurosz, acc);
+#else
+	icvGetConvKernel(neurosz)(src, weight, neurosz, acc);
+#endif
+}
+
+void CvSIMDBackend::convolvestrided(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+#ifdef __SSE2__
+	icvConvolveStridedSSE2(src, weight, neurosz, stride, acc);
+#else
+	icvGetStridedConvKernel(neurosz)(src, weight, neurosz, stride, acc);
+#endif
+}
+
+/*! Output rows are the outer loop, blocks of eight, four and then single
+ * planes go over the source rows of the output row while they are in L1.
+ */
+void CvSIMDBackend::convolvebank(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+#ifdef __SSE2__
+	if (n <= 0)
+		return;
+
+	assert( src->rows >= (acc[0]->rows-1)*stride.height+neurosz.height && src->cols >= (acc[0]->cols-1)*stride.width+neurosz.width );
+
+	for (int y=0; y<acc[0]->rows; y++)
+	{
+		int b = 0;
+		for (; b+8<=n; b+=8)
+			icvConvolveBankRowSSE2<8>(src, weight+b, neurosz, stride, acc+b, y);
+		for (; b+4<=n; b+=4)
+			icvConvolveBankRowSSE2<4>(src, weight+b, neurosz, stride, acc+b, y);
+		for (; b<n; b++)
+			icvConvolveBankRowSSE2<1>(src, weight+b, neurosz, stride, acc+b, y);
+	}
+#else
+	icvConvolveBankGeneric(src, weight, n, neurosz, stride, acc);
+#endif
+}
+
+void CvSIMDBackend::convolvepacked(const CvMat *src, const double *weight, int channels, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+#ifdef __SSE2__
+	icvConvolvePackedSSE2(src, weight, channels, neurosz, stride, acc);
+#else
+	icvConvolvePackedGeneric(src, weight, channels, neurosz, stride, acc);
+#endif
+}
+
+/*! Nonzero weights are scattered over the window, loading pairs of
+ * source values for them would cost more than it saves.
+ */
+void CvSIMDBackend::convolvesparse(const CvMat *src, const int *tap, const double *weight, int n, CvSize neurosz, CvSize stride, CvMat *acc)
+{
+	icvConvolveSparseGeneric(src, tap, weight, n, neurosz, stride, acc);
+}
+
+/*! A pixel updates runs of at most neurosz.width outputs, too short 
+ * to gain from pairs.
+ */
+void CvSIMDBackend::convolvescatter(const CvMat *src, const double **weight, int n, CvSize neurosz, CvSize stride, CvMat **acc)
+{
+	icvConvolveScatterGeneric(src, weight, n, neurosz, stride, acc);
+}
+
+/*! Border windows have varying length, so there is nothing to vectorize.
+ */
+void CvSIMDBackend::convolveclipped(const CvMat *src, const double *weight, CvSize neurosz, CvSize stride, CvPoint origin, CvRect skip, CvMat *acc)
+{
+	icvConvolveClipped(src, weight, neurosz, stride, origin, skip, acc);
+}
+
+void CvSIMDBackend::combine(const CvMat **src, const double *weight, int n, CvMat *acc)
+{
+#ifdef __SSE2__
+	for (int y=0; y<acc->rows; y++)
+	{
+		double *dst = ICV_ROW(acc,y);
+		for (int i=0; i<n; i++)
+		{
+			assert( src[i]->rows >= acc->rows && src[i]->cols >= acc->cols );
+
+			const double *s = ICV_ROW(src[i],y);
+			__m128d w2 = _mm_set1_pd(weight[i]);
+			int x = 0;
+			for (; x+1<acc->cols; x+=2)
+				_mm_storeu_pd(dst+x, _mm_add_pd(_mm_loadu_pd(dst+x), _mm_mul_pd(w2, _mm_loadu_pd(s+x))));
+			for (; x<acc->cols; x++)
+				dst[x] += weight[i]*s[x];
+		}
+	}
+#else
+	icvCombineGeneric(src, weight, n, acc);
+#endif
+}
+
+void CvSIMDBackend::interleave(const CvMat **src, int n, CvMat *dst)
+{
+	icvInterleave(src, n, dst);
+}
+
+void CvSIMDBackend::sumpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	icvGetSumPoolKernel(neurosz)(src, neurosz, acc);
+}
+
+void CvSIMDBackend::maxpool(const CvMat *src, CvSize neurosz, CvMat *acc)
+{
+	icvGetMaxPoolKernel(neurosz)(src, neurosz, acc);
+}
+
+double CvSIMDBackend::dense(const CvMat *src, const double *weight, CvSize neurosz)
+{
+#ifdef __SSE2__
+	assert( src->rows >= neurosz.height && src->cols >= neurosz.width );
+
+	// Two partial sums in one register, reduced at the end
+	__m128d sum2 = _mm_setzero_pd();
+	double sum = 0;
+	for (int j=0; j<neurosz.height; j++)
+	{
+		const double *s = ICV_ROW(src,j);
+		int k = 0;
+		for (; k+1<neurosz.width; k+=2, weight+=2)
+			sum2 = _mm_add_pd(sum2, _mm_mul_pd(_mm_loadu_pd(weight), _mm_loadu_pd(s+k)));
+		for (; k<neurosz.width; k++)
+			sum += (*weight++)*s[k];
+	}
+	double part[2];
+	_mm_storeu_pd(part, sum2);
+	return sum+part[0]+part[1];
+#else
+	return icvDotGeneric(src, weight, neurosz);
+#endif
+}
+
+double CvSIMDBackend::dotsparse(const CvMat *src, const int *index, const double *weight, int n)
+{
+	return icvDotSparseGeneric(src, index, weight, n);
+}
+
+double CvSIMDBackend::distance(const CvMat *src, const double *weight, CvSize neurosz)
+{
+#ifdef __SSE2__
+	assert( src->rows >= neurosz.height && src->cols >= neurosz.width );
+
+	__m128d sum2 = _mm_setzero_pd();
+	double sum = 0;
+	for (int j=0; j<neurosz.height; j++)
+	{
+		const double *s = ICV_ROW(src,j);
+		int k = 0;
+		for (; k+1<neurosz.width; k+=2, weight+=2)
+		{
+			__m128d d = _mm_sub_pd(_mm_loadu_pd(weight), _mm_loadu_pd(s+k));
+			sum2 = _mm_add_pd(sum2, _mm_mul_pd(d, d));
+		}
+		for (; k<neurosz.width; k++)
+		{
+			double d = (*weight++)-s[k];
+			sum += d*d;
+		}
+	}
+	double part[2];
+	_mm_storeu_pd(part, sum2);
+	return sum+part[0]+part[1];
+#else
+	return icvDistGeneric(src, weight, neurosz);
+#endif
+}
+
+void CvSIMDBackend::activate(CvMat *fmap, int activation, double scale, double shift)
+{
+	icvActivate(fmap, activation, scale, shift);
+}
+
+int CvSIMDBackend::argmax(const double *val, int n)
+{
+	return icvArgmax(val, n);
+}
@@ -41,9 +41,54 @@ preliminary and subject to change at any time, without notice.
 #include "cvsourceplane.h"
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
 
 using namespace std;
 
+/*! The function converts a row of a frame into grey values.
+ * Three and four channel frames are taken as BGR(A).
+ * \param row pointer to the row of the frame
+ * \param cn number of channels
+ * \param x0 first column to convert
+ * \param n number of columns to convert
+ * \param grey receives n grey values
+ */
+template <typename T> static void icvGreyRow(const T *row, int cn, int x0, int n, double *grey)
+{
+	row += x0*cn;
+	if (cn == 1)
+	{
+		for (int x = 0; x < n; x++)
+			grey[x] = row[x];
+	}
+	else
+	{
+		for (int x = 0; x < n; x++, row += cn)
+			grey[x] = 0.114*row[0] + 0.587*row[1] + 0.299*row[2];
+	}
+}
+
+//! Converts columns [x0,x0+n) of frame's row y into grey values
+static void icvGreyRow(const CvMat *frame, int y, int x0, int n, double *grey)
+{
+	const uchar *row = frame->data.ptr + (size_t)frame->step*y;
+	int cn = CV_MAT_CN(frame->type);
+
+	switch (CV_MAT_DEPTH(frame->type))
+	{
+	case CV_8U: 
+		icvGreyRow((const uchar *)row, cn, x0, n, grey); 
+		break;
+	case CV_32F: 
+		icvGreyRow((const float *)row, cn, x0, n, grey); 
+		break;
+	default: 
+		icvGreyRow((const double *)row, cn, x0, n, grey); 
+		break;
+	}
+}
+
 
 // Constructors/Destructors
 //  
@@ -57,6 +102,10 @@ using namespace std;
 CvSourcePlane::CvSourcePlane  (std::string id, CvSize fmapsz)
 	: CvGenericPlane(id, fmapsz, fmapsz) 
 {
+	m_padding = 0;
+	m_mean = 0.0;
+	m_scale = 1.0;
+	m_inputtype = "any";
 }
 
 CvSourcePlane::~CvSourcePlane ( ) 
@@ -76,6 +125,231 @@ CvMat * CvSourcePlane::fprop ()
 }
 
 
+/*! The method defines how input images are turned into the feature map.
+ * The input image is placed in the middle of the feature map surrounded
+ * by a border of given width, every pixel p becomes (p-mean)*scale.
+ * The border is filled as if it were made of zero pixels.
+ * \param padding width of the border around input image
+ * \param mean value subtracted from input pixels
+ * \param scale factor applied to input pixels after mean subtraction
+ * \param inputtype expected type of input pixels ("any", "uint8", "float32" or "float64")
+ * \return status of operation
+ */
+int CvSourcePlane::setpreprocessing ( int padding, double mean, double scale, std::string inputtype )
+{
+	if (padding < 0 || 2*padding >= m_fmapsz.width || 2*padding >= m_fmapsz.height)
+		return 0;
+
+	if (inputtype != "any" && inputtype != "uint8" && inputtype != "float32" && inputtype != "float64")
+		return 0;
+
+	m_padding = padding;
+	m_mean = mean;
+	m_scale = scale;
+	m_inputtype = inputtype;
+
+	// The border never changes
+	cvSet(m_fmap, cvRealScalar(-m_mean*m_scale));
+
+	return 1;
+}
+
+/*!
+ * \return size of the feature map without the border
+ */
+CvSize CvSourcePlane::getinputsz ( )
+{
+	return cvSize(m_fmapsz.width-2*m_padding, m_fmapsz.height-2*m_padding);
+}
+
+/*!
+ * \param mean value subtracted from input pixels (0 if not declared)
+ * \param scale factor applied after the subtraction (1 if not declared)
+ */
+void CvSourcePlane::getnormalization ( double &mean, double &scale )
+{
+	mean = m_mean;
+	scale = m_scale;
+}
+
+/*! The method preprocesses the input image straight into the 
+ * feature map in one pass, converting pixels to doubles, subtracting
+ * the mean and scaling at once.
+ * \param source input image (CvMat or IplImage) of getinputsz() size
+ * \return status
+ */
+int CvSourcePlane::setfmap ( CvArr * source )
+{
+	CvSize inputsz = getinputsz();
+
+	if ( (source == NULL) || !(cvGetSize(source).width == inputsz.width 
+		&& cvGetSize(source).height == inputsz.height) )
+		return 0;
+
+	int depth = CV_MAT_DEPTH(cvGetElemType(source));
+	if ( (m_inputtype == "uint8" && depth != CV_8U) 
+		|| (m_inputtype == "float32" && depth != CV_32F)
+		|| (m_inputtype == "float64" && depth != CV_64F) )
+		return 0;
+
+	CvMat region;
+	cvGetSubRect(m_fmap, &region, cvRect(m_padding, m_padding, inputsz.width, inputsz.height));
+	cvConvertScale(source, &region, m_scale, -m_mean*m_scale);
+
+	return 1;
+}
+
+/*! The method samples a region of a frame into the feature map,
+ * scaling it to getinputsz() with the given interpolation, so callers
+ * need neither a cropped nor a resized copy of the frame.
+ * Colour frames (BGR or BGRA) are converted to grey on the fly,
+ * and preprocessing of the plane is applied in the same pass.
+ * Only frame rows actually sampled are converted.
+ * \param frame frame (CvMat or IplImage) of 8U, 32F or 64F depth with 1, 3 or 4 channels
+ * \param roi region of the frame to be sampled
+ * \param interp interpolation: CV_INTER_NN or CV_INTER_LINEAR
+ * \return status
+ */
+int CvSourcePlane::setfmap ( CvArr * frame, CvRect roi, int interp )
+{
+	if (frame == NULL)
+		return 0;
+
+	CvMat hdr;
+	CvMat *mat = cvGetMat(frame, &hdr);
+	int cn = CV_MAT_CN(mat->type);
+	int depth = CV_MAT_DEPTH(mat->type);
+
+	if ( roi.x < 0 || roi.y < 0 || roi.width <= 0 || roi.height <= 0 
+		|| roi.x+roi.width > mat->cols || roi.y+roi.height > mat->rows )
+		return 0;
+
+	if ( (cn != 1 && cn != 3 && cn != 4) 
+		|| (depth != CV_8U && depth != CV_32F && depth != CV_64F) )
+		return 0;
+
+	if ( (m_inputtype == "uint8" && depth != CV_8U) 
+		|| (m_inputtype == "float32" && depth != CV_32F)
+		|| (m_inputtype == "float64" && depth != CV_64F) )
+		return 0;
+
+	if (interp != CV_INTER_NN && interp != CV_INTER_LINEAR)
+		return 0;
+
+	CvSize inputsz = getinputsz();
+	double sx = (double) roi.width/inputsz.width;
+	double sy = (double) roi.height/inputsz.height;
+	double shift = -m_mean*m_scale;
+
+	// Horizontal sampling table (relative to roi.x)
+	m_xofs.resize(inputsz.width);
+	m_xalpha.resize(inputsz.width);
+	for (int x = 0; x < inputsz.width; x++)
+	{
+		if (interp == CV_INTER_NN)
+		{
+			m_xofs[x] = MIN((int) (x*sx), roi.width-1);
+			m_xalpha[x] = 0.0;
+		}
+		else
+		{
+			double fx = MIN(MAX((x+0.5)*sx-0.5, 0.0), roi.width-1.0);
+			m_xofs[x] = MIN((int) fx, roi.width-2 < 0 ? 0 : roi.width-2);
+			m_xalpha[x] = (roi.width > 1) ? fx-m_xofs[x] : 0.0;
+		}
+	}
+
+	// Two grey rows of the roi
+	m_rowbuf.resize(2*roi.width);
+	double *row0 = &m_rowbuf[0];
+	double *row1 = &m_rowbuf[roi.width];
+	int have0 = -1, have1 = -1;
+
+	for (int y = 0; y < inputsz.height; y++)
+	{
+		int y0;
+		double beta = 0.0;
+
+		if (interp == CV_INTER_NN)
+		{
+			y0 = MIN((int) (y*sy), roi.height-1);
+		}
+		else
+		{
+			double fy = MIN(MAX((y+0.5)*sy-0.5, 0.0), roi.height-1.0);
+			y0 = MIN((int) fy, roi.height-2 < 0 ? 0 : roi.height-2);
+			beta = (roi.height > 1) ? fy-y0 : 0.0;
+		}
+
+		if (have0 != y0)
+		{
+			if (have1 == y0)
+			{
+				std::swap(row0, row1);
+				std::swap(have0, have1);
+			}
+			else
+			{
+				icvGreyRow(mat, roi.y+y0, roi.x, roi.width, row0);
+				have0 = y0;
+			}
+		}
+		if (beta > 0.0 && have1 != y0+1)
+		{
+			icvGreyRow(mat, roi.y+y0+1, roi.x, roi.width, row1);
+			have1 = y0+1;
+		}
+
+		double *dst = (double *)(m_fmap->data.ptr + (size_t)m_fmap->step*(y+m_padding)) + m_padding;
+		for (int x = 0; x < inputsz.width; x++)
+		{
+			int x0 = m_xofs[x];
+			double a = m_xalpha[x];
+			double v = row0[x0];
+
+			if (a > 0.0)
+				v += a*(row0[x0+1]-v);
+			if (beta > 0.0)
+			{
+				double v1 = row1[x0];
+				if (a > 0.0)
+					v1 += a*(row1[x0+1]-v1);
+				v += beta*(v1-v);
+			}
+
+			dst[x] = v*m_scale + shift;
+		}
+	}
+
+	return 1;
+}
+
+/*! Regions of input image are shifted by the border.
+ * \param prect region of the input image
+ * \return region of the feature map holding the input region
+ */
+CvRect CvSourcePlane::getdirtyrect ( CvRect prect )
+{
+	CvSize inputsz = getinputsz();
+	int x0 = MAX(prect.x, 0);
+	int y0 = MAX(prect.y, 0);
+	int x1 = MIN(prect.x+prect.width, inputsz.width);
+	int y1 = MIN(prect.y+prect.height, inputsz.height);
+
+	if (x1 <= x0 || y1 <= y0)
+		return cvRect(0,0,0,0);
+
+	return cvRect(x0+m_padding, y0+m_padding, x1-x0, y1-y0);
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvSourcePlane::gettype ( )
+{
+	return "source";
+}
+
 /*! The method produces an XML representation of the complete information about 
  * the source plane.
  * The only useful information about source plane is its name and its size.
@@ -88,8 +362,46 @@ CvMat * CvSourcePlane::fprop ()
 string CvSourcePlane::toString ( ) 
 {
 	ostringstream xml;
- 	xml << "\t<plane id=\"" << m_id << "\" type=\"source\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\">" << endl;
+	xml.precision(CVCONVNET_XML_PRECISION);
+ 	xml << "\t<plane id=\"" << m_id << "\" type=\"source\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\"";
+	if (m_padding != 0)
+		xml << " padding=\"" << m_padding << "\"";
+	if (m_mean != 0.0)
+		xml << " mean=\"" << setprecision(17) << m_mean << "\"";
+	if (m_scale != 1.0)
+		xml << " scale=\"" << setprecision(17) << m_scale << "\"";
+	if (m_inputtype != "any")
+		xml << " inputtype=\"" << m_inputtype << "\"";
+	xml << ">" << endl;
 	xml << "\t</plane>" << endl;
 	
 	return xml.str();
 }
+
+/*! The method produces C++ code that preprocesses the input image
+ * (row-major array of doubles named input) into the source plane.
+ * \return string containing C++ statements
+ */
+string CvSourcePlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+	CvSize inputsz = getinputsz();
+
+	code << setprecision(17);
+	code << "\t/* " << m_id << ": source " << m_fmapsz.width << "x" << m_fmapsz.height << ", input " << inputsz.width << "x" << inputsz.height << " */" << endl;
+	if (m_padding > 0)
+	{
+		code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+		code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+		code << "\t\t\ts->" << sym << "[y][x] = " << -m_mean*m_scale << ";" << endl;
+	}
+	code << "\tfor (y = 0; y < " << inputsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << inputsz.width << "; x++)" << endl;
+	code << "\t\t\ts->" << sym << "[y+" << m_padding << "][x+" << m_padding << "] = input[y*" << inputsz.width << " + x]";
+	if (m_scale != 1.0 || m_mean != 0.0)
+		code << "*" << m_scale << " + (" << -m_mean*m_scale << ")";
+	code << ";" << endl;
+
+	return code.str();
+}
@@ -62,7 +62,6 @@ CvSubSamplingPlane::CvSubSamplingPlane (std::string id, CvSize fmapsz, CvSize ne
 	: CvGenericPlane(id, fmapsz, neurosz) 
 {
 	m_weight.resize( 2 );
-	
 }
 
 CvSubSamplingPlane::~CvSubSamplingPlane ( ) 
@@ -89,39 +88,70 @@ CvMat * CvSubSamplingPlane::fprop ( )
 		return NULL;
 	}
 
-	for (int y=0; y<m_fmapsz.height; y++)
+	// Calculate the sum
+	cvSetZero(m_fmap);
+	for (int i = 0; i < m_pplane.size(); i++)
+	{
+		m_backend->sumpool(m_pfmap[i], m_neurosz, m_fmap);
+	}
+
+	// Standard Sigmoid of scaled sum plus bias
+	m_backend->activate(m_fmap, CVCONVNET_ACT_STDSIGMOID, m_weight[1], m_weight[0]);
+	return m_fmap;
+}
+
+/*! The method recomputes a region of plane's feature map.
+ * \param rect region of the feature map to be recomputed
+ * \return Pointer to plane's featuremap
+ */
+CvMat * CvSubSamplingPlane::fpropregion ( CvRect rect )
+{
+	assert( m_connected );
+	assert( rect.x >= 0 && rect.y >= 0 && rect.x+rect.width <= m_fmapsz.width && rect.y+rect.height <= m_fmapsz.height );
+
+	CvMat region, pregion;
+	cvGetSubRect(m_fmap, &region, rect);
+	cvSetZero(&region);
+
+	CvRect prect = cvRect(rect.x*m_neurosz.width, rect.y*m_neurosz.height, rect.width*m_neurosz.width, rect.height*m_neurosz.height);
+	for (int i = 0; i < m_pplane.size(); i++)
 	{
-		for (int x=0; x<m_fmapsz.width; x++)
-		{
-			double sum = 0; 
-			
-			// Calculate the sum
-			for (int i = 0; i < m_pplane.size(); i++)
-			{
-				CvMat *fmap = m_pfmap[i];
-				assert( cvGetSize(fmap).height >= (y+1)*m_neurosz.height
-					&& cvGetSize(fmap).width >= (x+1)*m_neurosz.width);
-
-				for (int j=0; j<m_neurosz.height; j++)
-				{
-					for (int k=0; k<m_neurosz.width; k++)
-					{
-						sum += cvmGet(fmap, y*m_neurosz.height+j, x*m_neurosz.width+k);
-					}
-				}
-			}
-
-			// Standard Sigmoid
-// 			double val = 1.71593428*tanh(0.66666666*(m_weight[0]+m_weight[1]*sum));
-			double val = DQstdsigmoid(m_weight[0]+m_weight[1]*sum);
-
-			// Update the value at feature map
-			cvmSet(m_fmap,y,x,val);
-		}
+		cvGetSubRect(m_pfmap[i], &pregion, prect);
+		m_backend->sumpool(&pregion, m_neurosz, &region);
 	}
+
+	m_backend->activate(&region, CVCONVNET_ACT_STDSIGMOID, m_weight[1], m_weight[0]);
 	return m_fmap;
 }
 
+/*! Windows don't overlap, so a parent's region maps into 
+ * the windows it touches.
+ * \param prect changed region of a parent's feature map
+ * \return region of plane's feature map to recompute (may be empty)
+ */
+CvRect CvSubSamplingPlane::getdirtyrect ( CvRect prect )
+{
+	if (prect.width <= 0 || prect.height <= 0)
+		return cvRect(0,0,0,0);
+
+	int x0 = prect.x/m_neurosz.width;
+	int y0 = prect.y/m_neurosz.height;
+	int x1 = MIN((prect.x+prect.width-1)/m_neurosz.width+1, m_fmapsz.width);
+	int y1 = MIN((prect.y+prect.height-1)/m_neurosz.height+1, m_fmapsz.height);
+
+	if (x1 <= x0 || y1 <= y0)
+		return cvRect(0,0,0,0);
+
+	return cvRect(x0, y0, x1-x0, y1-y0);
+}
+
+/*!
+ * \return type of the plane as used in XML
+ */
+string CvSubSamplingPlane::gettype ( )
+{
+	return "subsampling";
+}
 
 /*! The method produces an XML representation of the complete information about 
  * the plane including information about weights of neuron and connection to
@@ -134,6 +164,7 @@ CvMat * CvSubSamplingPlane::fprop ( )
 string CvSubSamplingPlane::toString ( ) 
 {
 	ostringstream xml;
+	xml.precision(CVCONVNET_XML_PRECISION);
  	xml << "\t<plane id=\"" << m_id << "\" type=\"subsampling\" featuremapsize=\"" << m_fmapsz.width << "x" << m_fmapsz.height << "\" neuronsize=\"" << m_neurosz.width << "x" << m_neurosz.height << "\">" << endl;
 	
 	for (int i=0; i <m_pplane.size(); i++)
@@ -148,6 +179,31 @@ string CvSubSamplingPlane::toString ( )
 	return xml.str();
 }
 
+/*! The method produces C++ code computing the feature map of the plane.
+ * \return string containing C++ statements
+ */
+string CvSubSamplingPlane::toCode ( )
+{
+	ostringstream code;
+	string sym = getsymbol();
+
+	code << "\t/* " << m_id << ": subsampling " << m_fmapsz.width << "x" << m_fmapsz.height << ", neuron " << m_neurosz.width << "x" << m_neurosz.height << " */" << endl;
+	code << "\tfor (y = 0; y < " << m_fmapsz.height << "; y++)" << endl;
+	code << "\t\tfor (x = 0; x < " << m_fmapsz.width << "; x++)" << endl;
+	code << "\t\t{" << endl;
+	code << "\t\t\tsum = 0;" << endl;
+	for (int i=0; i<m_pplane.size(); i++)
+	{
+		code << "\t\t\tfor (j = 0; j < " << m_neurosz.height << "; j++)" << endl;
+		code << "\t\t\t\tfor (k = 0; k < " << m_neurosz.width << "; k++)" << endl;
+		code << "\t\t\t\t\tsum += s->" << m_pplane[i]->getsymbol() << "[y*" << m_neurosz.height << "+j][x*" << m_neurosz.width << "+k];" << endl;
+	}
+	code << "\t\t\ts->" << sym << "[y][x] = stdsigmoid(" << sym << "_w[0] + " << sym << "_w[1]*sum);" << endl;
+	code << "\t\t}" << endl;
+
+	return code.str();
+}
+
 /*! The method explicitly sets the weights of the neuron
  */
 int CvSubSamplingPlane::setweight(std::vector<double> &weights)
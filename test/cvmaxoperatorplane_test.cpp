@@ -6,14 +6,30 @@
                                         " result:" << a);\
 }
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include <boost/test/unit_test.hpp>
 #include <opencv/cv.h>
 
+#include "boundedqueue.h"
+#include "cvbackend.h"
+#include "cvconvnet.h"
+#include "cvconvnettuner.h"
 #include "cvconvolutionplane.h"
+#include "cvdenseplane.h"
+#include "cvdepthwiseplane.h"
 #include "cvgenericplane.h"
 #include "cvmaxoperatorplane.h"
+#include "cvpointwiseplane.h"
+#include "cvrbfplane.h"
 #include "cvregressionplane.h"
+#include "cvresultcache.h"
 #include "cvsourceplane.h"
 
 CvSourcePlane createTestCvSourcePlane()
@@ -28,6 +44,88 @@ CvMaxOperatorPlane createTestMaxOperatorPlane(CvSize featureMapSize,
     return CvMaxOperatorPlane("test_max", featureMapSize, neuronSize);
 } // createTestMaxOperatorPlane
 
+// Compiler used to build code generated from the test network
+#ifndef CVCONVNET_TEST_CXX
+#define CVCONVNET_TEST_CXX "c++"
+#endif
+
+// Deterministic weights in [-0.3, 0.3)
+double testWeight(int i)
+{
+    return 0.6 * ((i * 37 + 11) % 23) / 23.0 - 0.3;
+} // testWeight
+
+// Appends a plane with its bias and one connection per parent to the XML
+void appendTestPlane(std::ostringstream& xml,
+                     int& seed,
+                     std::string id,
+                     std::string type,
+                     std::string size,
+                     std::string neuron,
+                     std::vector<std::string> parents,
+                     int weights)
+{
+    xml << "<plane id=\"" << id << "\" type=\"" << type
+        << "\" featuremapsize=\"" << size << "\" neuronsize=\"" << neuron
+        << "\"><bias> " << testWeight(seed++) << " </bias>";
+    for (int p = 0; p < parents.size(); p++)
+    {
+        xml << "<connection to=\"" << parents[p] << "\">";
+        for (int w = 0; w < weights; w++)
+        {
+            xml << " " << testWeight(seed++);
+        }
+        xml << " </connection>";
+    }
+    xml << "</plane>" << std::endl;
+} // appendTestPlane
+
+// Small LeNet-like network on 12x12 input with two outputs, exits are
+// inserted before the closing tag
+std::string createTestNetXml(std::string exits = "")
+{
+    std::ostringstream xml;
+    int seed = 0;
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+    xml << "<net name=\"test\" creator=\"test\">" << std::endl;
+    xml << "<info> test </info>" << std::endl;
+    xml << "<plane id=\"src\" type=\"source\" featuremapsize=\"12x12\"></plane>" << std::endl;
+    appendTestPlane(xml, seed, "c1_0", "convolution", "8x8", "5x5",
+                    std::vector<std::string>(1, "src"), 25);
+    appendTestPlane(xml, seed, "c1_1", "convolution", "8x8", "5x5",
+                    std::vector<std::string>(1, "src"), 25);
+    appendTestPlane(xml, seed, "s2_0", "subsampling", "4x4", "2x2",
+                    std::vector<std::string>(1, "c1_0"), 1);
+    appendTestPlane(xml, seed, "s2_1", "subsampling", "4x4", "2x2",
+                    std::vector<std::string>(1, "c1_1"), 1);
+    std::vector<std::string> c3Parents;
+    c3Parents.push_back("s2_0");
+    c3Parents.push_back("s2_1");
+    appendTestPlane(xml, seed, "c3_0", "convolution", "2x2", "3x3",
+                    c3Parents, 9);
+    appendTestPlane(xml, seed, "out0", "regression", "1x1", "2x2",
+                    std::vector<std::string>(1, "c3_0"), 4);
+    appendTestPlane(xml, seed, "out1", "regression", "1x1", "2x2",
+                    std::vector<std::string>(1, "c3_0"), 4);
+    xml << "<plane id=\"res\" type=\"max\"><connection to=\"out0\">"
+        << "</connection><connection to=\"out1\"></connection></plane>"
+        << std::endl;
+    xml << exits;
+    xml << "</net>" << std::endl;
+    return xml.str();
+} // createTestNetXml
+
+// Deterministic 12x12 input, k selects one of several images
+void fillTestInput(CvMat* input, int k)
+{
+    for (int y = 0; y < input->rows; y++)
+    {
+        for (int x = 0; x < input->cols; x++)
+        {
+            cvmSet(input, y, x, ((y * 7 + x * 13 + k * 5) % 17) / 17.0 - 0.3);
+        }
+    }
+} // fillTestInput
 
 BOOST_AUTO_TEST_CASE( full_fprop_test )
 {
@@ -176,6 +274,358 @@ BOOST_AUTO_TEST_CASE( cvconvolutionplane_test )
     CHECK_MESSAGE(cvmGet(fprop1, 1, 1), tanh(16.3));
     CHECK_MESSAGE(cvmGet(fprop1, 5, 5), tanh(48.7));
 
+    // Removing a parent removes its window and keeps the bias
+    CvSourcePlane secondPlane = createTestCvSourcePlane();
+    parentPlanes.push_back(&secondPlane);
+    CvConvolutionPlane* twoParentPlane = new CvConvolutionPlane("test_conv2",
+                                                               cvSize(6, 6),
+                                                               cvSize(3, 3));
+    std::vector<double> twoParentWeights(19, 0.1);
+    twoParentWeights[0] = 0.5;
+    twoParentWeights[10] = 0.3;
+    CHECK_MESSAGE(twoParentPlane->connto(parentPlanes), 1);
+    CHECK_MESSAGE(twoParentPlane->setweight(twoParentWeights), 1);
+    int removed = twoParentPlane->removeparent(0);
+    CHECK_MESSAGE(removed, 1);
+    CHECK_MESSAGE(twoParentPlane->getparents().size(), 1);
+    CHECK_MESSAGE(twoParentPlane->getparents()[0], &secondPlane);
+    CHECK_MESSAGE(twoParentPlane->getweight().size(), 10);
+    CHECK_MESSAGE(twoParentPlane->getweight()[0], 0.5);
+    CHECK_MESSAGE(twoParentPlane->getweight()[1], 0.3);
+    CHECK_MESSAGE(twoParentPlane->removeparent(1), 0);
+    delete twoParentPlane;
+
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvolutionplane_factor_test )
+{
+    CvSourcePlane sourcePlane = createTestCvSourcePlane();
+
+    double sourcePlaneFeatureMapValues[64];
+    for (int i = 0; i < 64; i++)
+    {
+        sourcePlaneFeatureMapValues[i] = i;
+    }
+    CvMat sourcePlaneFeatureMap = cvMat(8,
+                                        8,
+                                        CV_64FC1,
+                                        sourcePlaneFeatureMapValues);
+    CHECK_MESSAGE(sourcePlane.setfmap(&sourcePlaneFeatureMap), 1);
+
+    std::vector<CvGenericPlane *> parentPlanes;
+    parentPlanes.push_back(&sourcePlane);
+
+    // Separable kernel (0.1 0.2 0.1)^T (0.1 0.2 0.1) without activation
+    CvDepthwisePlane* depthwisePlane = new CvDepthwisePlane("test_dw",
+                                                            cvSize(6, 6),
+                                                            cvSize(3, 3));
+    double factor[] = { 0.1, 0.2, 0.1 };
+    std::vector<double> weights(10, 0.0);
+    for (int j = 0; j < 3; j++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            weights[1 + j * 3 + k] = factor[j] * factor[k];
+        }
+    }
+    CHECK_MESSAGE(depthwisePlane->connto(parentPlanes), 1);
+    CHECK_MESSAGE(depthwisePlane->setweight(weights), 1);
+
+    // Already computed in separable form
+    int replaced = depthwisePlane->approximate(0.5);
+    CHECK_MESSAGE(replaced, 0);
+
+    CvMat* fprop1 = depthwisePlane->fprop();
+    for (int y = 0; y < 6; y++)
+    {
+        for (int x = 0; x < 6; x++)
+        {
+            BOOST_CHECK_SMALL(cvmGet(fprop1, y, x)
+                              - (0.16 * (8 * y + x) + 1.44), 1e-12);
+        }
+    }
+
+    // Perturbed kernel is replaced by its rank one approximation
+    weights[5] += 0.001;
+    CHECK_MESSAGE(depthwisePlane->setweight(weights), 1);
+    replaced = depthwisePlane->approximate(0.0);
+    CHECK_MESSAGE(replaced, 0);
+    replaced = depthwisePlane->approximate(0.1);
+    CHECK_MESSAGE(replaced, 1);
+
+    fprop1 = depthwisePlane->fprop();
+    for (int y = 0; y < 6; y++)
+    {
+        for (int x = 0; x < 6; x++)
+        {
+            BOOST_CHECK_SMALL(cvmGet(fprop1, y, x)
+                              - (0.16 * (8 * y + x) + 1.44), 0.1);
+        }
+    }
+    delete depthwisePlane;
+
+    // Only kernels whose weights change are factored again
+    std::vector<CvGenericPlane *> twoParents(2, &sourcePlane);
+    CvConvolutionPlane convPlane("test_conv", cvSize(6, 6), cvSize(3, 3));
+    CvConvolutionPlane freshPlane("test_fresh", cvSize(6, 6), cvSize(3, 3));
+    std::vector<double> convWeights(19, 0.0);
+    for (int t = 0; t < 9; t++)
+    {
+        convWeights[1 + t] = factor[t / 3] * factor[t % 3];
+        convWeights[10 + t] = testWeight(t);
+    }
+    CHECK_MESSAGE(convPlane.connto(twoParents), 1);
+    CHECK_MESSAGE(convPlane.setweight(convWeights), 1);
+    CHECK_MESSAGE(convPlane.getform(),
+                  "stride 1x1 padding 0x0 kernels 0/1/0/1");
+    convWeights[12] += 0.5;
+    CHECK_MESSAGE(convPlane.setweight(convWeights), 1);
+    CHECK_MESSAGE(convPlane.getform(),
+                  "stride 1x1 padding 0x0 kernels 0/1/0/1");
+    convWeights[2] += 0.5;
+    CHECK_MESSAGE(convPlane.setweight(convWeights), 1);
+    CHECK_MESSAGE(convPlane.getform(),
+                  "stride 1x1 padding 0x0 kernels 0/2/0/0");
+
+    CHECK_MESSAGE(freshPlane.connto(twoParents), 1);
+    CHECK_MESSAGE(freshPlane.setweight(convWeights), 1);
+    CvMat* fprop2 = convPlane.fprop();
+    CvMat* fresh = freshPlane.fprop();
+    for (int y = 0; y < 6; y++)
+    {
+        for (int x = 0; x < 6; x++)
+        {
+            CHECK_MESSAGE(cvmGet(fprop2, y, x), cvmGet(fresh, y, x));
+        }
+    }
+
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvpointwiseplane_test )
+{
+    CvSourcePlane sourcePlane0("test_source0", cvSize(4, 4));
+    CvSourcePlane sourcePlane1("test_source1", cvSize(4, 4));
+    CvSourcePlane smallPlane("test_small", cvSize(3, 3));
+    CvMat* input0 = cvCreateMat(4, 4, CV_64FC1);
+    CvMat* input1 = cvCreateMat(4, 4, CV_64FC1);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            cvmSet(input0, y, x, sin(1.7 * (y * 4 + x)));
+            cvmSet(input1, y, x, cos(0.9 * (y * 4 + x)));
+        }
+    }
+    CHECK_MESSAGE(sourcePlane0.setfmap(input0), 1);
+    CHECK_MESSAGE(sourcePlane1.setfmap(input1), 1);
+    std::vector<CvGenericPlane *> parentPlanes;
+    parentPlanes.push_back(&sourcePlane0);
+    parentPlanes.push_back(&sourcePlane1);
+
+    // Weights are the bias and one weight per parent of the same size
+    CvPointwisePlane pointwisePlane("test_pw", cvSize(4, 4));
+    CHECK_MESSAGE(pointwisePlane.connto(parentPlanes), 1);
+    std::vector<double> weights(2, 0.1);
+    CHECK_MESSAGE(pointwisePlane.setweight(weights), 0);
+    weights.push_back(-0.7);
+    weights[1] = 0.4;
+    CHECK_MESSAGE(pointwisePlane.setweight(weights), 1);
+
+    CvPointwisePlane mismatchedPlane("test_mismatched", cvSize(4, 4));
+    std::vector<CvGenericPlane *> mismatchedParents(1, &smallPlane);
+    CHECK_MESSAGE(mismatchedPlane.connto(mismatchedParents), 1);
+    std::vector<double> mismatchedWeights(2, 0.1);
+    CHECK_MESSAGE(mismatchedPlane.setweight(mismatchedWeights), 0);
+
+    CvMat* fprop1 = pointwisePlane.fprop();
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            double expected = tanh(0.1 + 0.4 * cvmGet(input0, y, x)
+                                   - 0.7 * cvmGet(input1, y, x));
+            BOOST_CHECK_SMALL(cvmGet(fprop1, y, x) - expected, 1e-12);
+        }
+    }
+
+    // Only the region is recomputed from the changed parents
+    CvMat* previous = cvCloneMat(fprop1);
+    cvSet(input0, cvRealScalar(0.5));
+    CHECK_MESSAGE(sourcePlane0.setfmap(input0), 1);
+    CvRect rect = cvRect(1, 2, 2, 1);
+    CHECK_MESSAGE(pointwisePlane.getdirtyrect(cvRect(-1, 2, 4, 5)).height, 2);
+    fprop1 = pointwisePlane.fpropregion(rect);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            bool inside = x >= rect.x && x < rect.x + rect.width
+                          && y >= rect.y && y < rect.y + rect.height;
+            double expected = inside
+                ? tanh(0.1 + 0.2 - 0.7 * cvmGet(input1, y, x))
+                : cvmGet(previous, y, x);
+            BOOST_CHECK_SMALL(cvmGet(fprop1, y, x) - expected, 1e-12);
+        }
+    }
+    cvReleaseMat(&previous);
+
+    // The leader computes the whole group in one pass over the parents
+    std::vector<CvPointwisePlane *> group, single;
+    for (int g = 0; g < 3; g++)
+    {
+        std::ostringstream id;
+        id << "test_pw" << g;
+        group.push_back(new CvPointwisePlane(id.str(), cvSize(4, 4)));
+        single.push_back(new CvPointwisePlane(id.str(), cvSize(4, 4)));
+
+        std::vector<double> groupWeights(3);
+        for (int t = 0; t < 3; t++)
+        {
+            groupWeights[t] = testWeight(g * 3 + t);
+        }
+        CHECK_MESSAGE(group[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(group[g]->setweight(groupWeights), 1);
+        CHECK_MESSAGE(single[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(single[g]->setweight(groupWeights), 1);
+    }
+    std::vector<CvPointwisePlane *> mixed;
+    mixed.push_back(&pointwisePlane);
+    mixed.push_back(&mismatchedPlane);
+    int shared = pointwisePlane.share(mixed);
+    CHECK_MESSAGE(shared, 0);
+    shared = group[0]->share(group);
+    CHECK_MESSAGE(shared, 1);
+
+    group[0]->fprop();
+    for (int g = 0; g < 3; g++)
+    {
+        CvMat* expected = single[g]->fprop();
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                BOOST_CHECK_SMALL(cvmGet(group[g]->getfmap(), y, x)
+                                  - cvmGet(expected, y, x), 1e-12);
+            }
+        }
+    }
+
+    cvSet(input1, cvRealScalar(-0.25));
+    CHECK_MESSAGE(sourcePlane1.setfmap(input1), 1);
+    group[2]->fpropregion(rect);
+    group[0]->fpropregion(rect);
+    for (int g = 0; g < 3; g++)
+    {
+        CvMat* expected = single[g]->fprop();
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                bool inside = x >= rect.x && x < rect.x + rect.width
+                              && y >= rect.y && y < rect.y + rect.height;
+                double result = cvmGet(group[g]->getfmap(), y, x);
+                if (inside)
+                {
+                    BOOST_CHECK_SMALL(result - cvmGet(expected, y, x), 1e-12);
+                }
+                else
+                {
+                    BOOST_CHECK(fabs(result - cvmGet(expected, y, x)) > 1e-6);
+                }
+            }
+        }
+    }
+
+    // Removing a parent removes its weight
+    int removed = pointwisePlane.removeparent(2);
+    CHECK_MESSAGE(removed, 0);
+    removed = pointwisePlane.removeparent(0);
+    CHECK_MESSAGE(removed, 1);
+    CHECK_MESSAGE(pointwisePlane.getweight().size(), 2);
+    CHECK_MESSAGE(pointwisePlane.getweight()[1], -0.7);
+    std::vector<CvGenericPlane *> remainingParents(1, &sourcePlane1);
+    CHECK_MESSAGE(pointwisePlane.connto(remainingParents), 1);
+    fprop1 = pointwisePlane.fprop();
+    BOOST_CHECK_SMALL(cvmGet(fprop1, 3, 3) - tanh(0.1 + 0.7 * 0.25), 1e-12);
+
+    for (int g = 0; g < 3; g++)
+    {
+        delete group[g];
+        delete single[g];
+    }
+    cvReleaseMat(&input0);
+    cvReleaseMat(&input1);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvolutionplane_padding_test )
+{
+    CvSourcePlane sourcePlane = createTestCvSourcePlane();
+    CvMat* input = cvCreateMat(8, 8, CV_64FC1);
+    for (int y = 0; y < 8; y++)
+    {
+        for (int x = 0; x < 8; x++)
+        {
+            cvmSet(input, y, x, testWeight(y * 8 + x));
+        }
+    }
+    CHECK_MESSAGE(sourcePlane.setfmap(input), 1);
+    std::vector<CvGenericPlane *> parentPlanes(1, &sourcePlane);
+
+    // Implicit padding equals a parent padded by zeros explicitly,
+    // outputs near the border are computed by the clipped convolution
+    CvSize neuron[] = { cvSize(3, 3), cvSize(3, 3), cvSize(5, 3) };
+    CvSize padding[] = { cvSize(1, 1), cvSize(1, 1), cvSize(2, 1) };
+    CvSize stride[] = { cvSize(1, 1), cvSize(2, 2), cvSize(2, 1) };
+    std::vector<std::string> names = cvGetBackendNames();
+    for (int c = 0; c < 3; c++)
+    {
+        CvSize paddedsz = cvSize(8 + 2 * padding[c].width,
+                                 8 + 2 * padding[c].height);
+        CvMat* padded = cvCreateMat(paddedsz.height, paddedsz.width, CV_64FC1);
+        cvZero(padded);
+        CvMat interior;
+        cvGetSubRect(padded, &interior,
+                     cvRect(padding[c].width, padding[c].height, 8, 8));
+        cvCopy(input, &interior);
+        CvSourcePlane paddedSource("test_padded_source", paddedsz);
+        CHECK_MESSAGE(paddedSource.setfmap(padded), 1);
+        std::vector<CvGenericPlane *> paddedParents(1, &paddedSource);
+
+        CvSize fmapsz = cvSize((paddedsz.width - neuron[c].width) / stride[c].width + 1,
+                               (paddedsz.height - neuron[c].height) / stride[c].height + 1);
+        CvConvolutionPlane paddedPlane("test_padded", fmapsz, neuron[c],
+                                       stride[c], padding[c]);
+        CvConvolutionPlane explicitPlane("test_explicit", fmapsz, neuron[c],
+                                         stride[c]);
+        std::vector<double> weights(neuron[c].width * neuron[c].height + 1);
+        for (int i = 0; i < weights.size(); i++)
+        {
+            weights[i] = testWeight(i + c);
+        }
+        CHECK_MESSAGE(paddedPlane.connto(parentPlanes), 1);
+        CHECK_MESSAGE(paddedPlane.setweight(weights), 1);
+        CHECK_MESSAGE(explicitPlane.connto(paddedParents), 1);
+        CHECK_MESSAGE(explicitPlane.setweight(weights), 1);
+
+        for (int b = 0; b < names.size(); b++)
+        {
+            paddedPlane.setbackend(cvGetBackend(names[b]));
+            explicitPlane.setbackend(cvGetBackend(names[b]));
+            CvMat* result = paddedPlane.fprop();
+            CvMat* expected = explicitPlane.fprop();
+            for (int y = 0; y < fmapsz.height; y++)
+            {
+                for (int x = 0; x < fmapsz.width; x++)
+                {
+                    BOOST_CHECK_SMALL(cvmGet(result, y, x)
+                                      - cvmGet(expected, y, x), 1e-12);
+                }
+            }
+        }
+        cvReleaseMat(&padded);
+    }
+
+    cvReleaseMat(&input);
 } // BOOST_AUTO_TEST_CASE
 
 BOOST_AUTO_TEST_CASE( cvregressionplane_test )
@@ -316,6 +766,155 @@ BOOST_AUTO_TEST_CASE( cvregressionplane_test )
     //                            cvSize()
 } // BOOST_AUTO_TEST_CASE
 
+BOOST_AUTO_TEST_CASE( cvrbfplane_group_test )
+{
+    CvSourcePlane sourcePlane0("test_source0", cvSize(4, 4));
+    CvSourcePlane sourcePlane1("test_source1", cvSize(4, 4));
+    CvMat* input = cvCreateMat(4, 4, CV_64FC1);
+    for (int k = 0; k < 2; k++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                cvmSet(input, y, x, sin(1.7 * (k * 16 + y * 4 + x)));
+            }
+        }
+        CHECK_MESSAGE((k ? sourcePlane1 : sourcePlane0).setfmap(input), 1);
+    }
+    std::vector<CvGenericPlane *> parentPlanes;
+    parentPlanes.push_back(&sourcePlane0);
+    parentPlanes.push_back(&sourcePlane1);
+
+    // The last plane's weights are almost the input, rounding makes its
+    // expanded distance negative
+    std::vector<CvRBFPlane *> group, single;
+    for (int g = 0; g < 3; g++)
+    {
+        std::ostringstream id;
+        id << "test_rbf" << g;
+        group.push_back(new CvRBFPlane(id.str(), cvSize(1, 1), cvSize(4, 4)));
+        single.push_back(new CvRBFPlane(id.str(), cvSize(1, 1), cvSize(4, 4)));
+
+        std::vector<double> weights(32);
+        for (int t = 0; t < 32; t++)
+        {
+            weights[t] = (g < 2) ? testWeight(g * 32 + t)
+                                 : sin(1.7 * t) + 1e-9;
+        }
+        CHECK_MESSAGE(group[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(group[g]->setweight(weights), 1);
+        CHECK_MESSAGE(single[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(single[g]->setweight(weights), 1);
+    }
+    int shared = group[0]->share(group);
+    CHECK_MESSAGE(shared, 1);
+
+    // The leader computes the whole group from ||x||^2 - 2x.w + ||w||^2
+    group[0]->fprop();
+    for (int g = 0; g < 3; g++)
+    {
+        double expected = cvmGet(single[g]->fprop(), 0, 0);
+        double result = cvmGet(group[g]->getfmap(), 0, 0);
+        BOOST_CHECK_SMALL(result - expected, 1e-9);
+    }
+    CHECK_MESSAGE(cvmGet(group[2]->getfmap(), 0, 0), 0);
+
+    // New weights of a member take effect on the leader's next fprop
+    std::vector<double> weights(32, 0.0);
+    CHECK_MESSAGE(group[1]->setweight(weights), 1);
+    CHECK_MESSAGE(single[1]->setweight(weights), 1);
+    group[1]->fprop();
+    group[0]->fprop();
+    double expected = cvmGet(single[1]->fprop(), 0, 0);
+    BOOST_CHECK_SMALL(cvmGet(group[1]->getfmap(), 0, 0) - expected, 1e-9);
+
+    for (int g = 0; g < 3; g++)
+    {
+        delete group[g];
+        delete single[g];
+    }
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvregressionplane_group_test )
+{
+    CvSourcePlane sourcePlane0("test_source0", cvSize(3, 3));
+    CvSourcePlane sourcePlane1("test_source1", cvSize(3, 3));
+    CvMat* input = cvCreateMat(3, 3, CV_64FC1);
+    for (int k = 0; k < 2; k++)
+    {
+        for (int y = 0; y < 3; y++)
+        {
+            for (int x = 0; x < 3; x++)
+            {
+                cvmSet(input, y, x, testWeight(k * 9 + y * 3 + x));
+            }
+        }
+        CHECK_MESSAGE((k ? sourcePlane1 : sourcePlane0).setfmap(input), 1);
+    }
+    std::vector<CvGenericPlane *> parentPlanes;
+    parentPlanes.push_back(&sourcePlane0);
+    parentPlanes.push_back(&sourcePlane1);
+
+    // The last plane is pruned down to a sparse row of the dense plane
+    std::vector<CvRegressionPlane *> group, single;
+    std::vector<double> xmlWeights(3 * 9);
+    for (int g = 0; g < 3; g++)
+    {
+        std::ostringstream id;
+        id << "test_regression" << g;
+        group.push_back(new CvRegressionPlane(id.str(), cvSize(2, 2)));
+        single.push_back(new CvRegressionPlane(id.str(), cvSize(2, 2)));
+
+        std::vector<double> weights(9, 0.0);
+        for (int t = 0; t < 9; t++)
+        {
+            if (g < 2 || t == 0 || t == 6)
+            {
+                weights[t] = testWeight(g * 9 + t + 5);
+            }
+        }
+        xmlWeights[g] = weights[0];
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                xmlWeights[3 + (i * 3 + g) * 4 + j] = weights[1 + i * 4 + j];
+            }
+        }
+        CHECK_MESSAGE(group[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(group[g]->setweight(weights), 1);
+        CHECK_MESSAGE(single[g]->connto(parentPlanes), 1);
+        CHECK_MESSAGE(single[g]->setweight(weights), 1);
+    }
+    int shared = group[0]->share(group);
+    CHECK_MESSAGE(shared, 1);
+    CHECK_MESSAGE(group[0]->getform(), "sparse 1");
+
+    // The same outputs from a dense plane of the network
+    CvDensePlane densePlane("test_dense", 3, cvSize(2, 2));
+    CHECK_MESSAGE(densePlane.connto(parentPlanes), 1);
+    CHECK_MESSAGE(densePlane.setweight(xmlWeights), 1);
+    CvMat* dense = densePlane.fprop();
+
+    // The leader computes the group, the others copy their outputs
+    for (int g = 0; g < 3; g++)
+    {
+        double result = cvmGet(group[g]->fprop(), 0, 0);
+        double expected = cvmGet(single[g]->fprop(), 0, 0);
+        BOOST_CHECK_SMALL(result - expected, 1e-12);
+        BOOST_CHECK_SMALL(cvmGet(dense, 0, g) - expected, 1e-12);
+    }
+
+    for (int g = 0; g < 3; g++)
+    {
+        delete group[g];
+        delete single[g];
+    }
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
 BOOST_AUTO_TEST_CASE( cvmaxoperatorplane_test )
 {
     CvSourcePlane sourcePlane = createTestCvSourcePlane();
@@ -401,3 +1000,991 @@ BOOST_AUTO_TEST_CASE( cvsourceplane_test )
     CHECK_MESSAGE(sourcePlane.setfmap(&testFeatureMap), 1);
 } // BOOST_AUTO_TEST_CASE
 
+BOOST_AUTO_TEST_CASE( cvsourceplane_preprocessing_test )
+{
+    // 8x8 plane taking 4x4 images padded by 2 pixels
+    CvSourcePlane sourcePlane("test_source_plane", cvSize(8, 8));
+    double mean = 100.0;
+    double scale = 1.0 / 255.0;
+    CHECK_MESSAGE(sourcePlane.setpreprocessing(4, mean, scale, "uint8"), 0);
+    CHECK_MESSAGE(sourcePlane.setpreprocessing(2, mean, scale, "int16"), 0);
+    CHECK_MESSAGE(sourcePlane.setpreprocessing(2, mean, scale, "uint8"), 1);
+    CvSize inputsz = sourcePlane.getinputsz();
+    CHECK_MESSAGE(inputsz.width, 4);
+    CHECK_MESSAGE(inputsz.height, 4);
+    double declaredMean = 0.0;
+    double declaredScale = 0.0;
+    sourcePlane.getnormalization(declaredMean, declaredScale);
+    CHECK_MESSAGE(declaredMean, mean);
+    CHECK_MESSAGE(declaredScale, scale);
+
+    unsigned char pixels[16];
+    for (int i = 0; i < 16; i++)
+    {
+        pixels[i] = (unsigned char) (i * 16);
+    }
+    CvMat image = cvMat(4, 4, CV_8UC1, pixels);
+    CHECK_MESSAGE(sourcePlane.setfmap(&image), 1);
+
+    // The border is a black pixel after preprocessing
+    const CvMat* fmap = sourcePlane.getfmap();
+    for (int y = 0; y < 8; y++)
+    {
+        for (int x = 0; x < 8; x++)
+        {
+            double expected = -mean * scale;
+            if (x >= 2 && x < 6 && y >= 2 && y < 6)
+            {
+                expected = (pixels[(y - 2) * 4 + (x - 2)] - mean) * scale;
+            }
+            BOOST_CHECK_SMALL(cvmGet(fmap, y, x) - expected, 1e-12);
+        }
+    }
+
+    // Images of the feature map size or of another type are rejected
+    CvMat* padded = cvCreateMat(8, 8, CV_8UC1);
+    cvZero(padded);
+    CHECK_MESSAGE(sourcePlane.setfmap(padded), 0);
+    cvReleaseMat(&padded);
+    CvMat* floats = cvCreateMat(4, 4, CV_32FC1);
+    cvZero(floats);
+    CHECK_MESSAGE(sourcePlane.setfmap(floats), 0);
+    cvReleaseMat(&floats);
+    BOOST_CHECK_SMALL(cvmGet(fmap, 2, 2) + mean * scale, 1e-12);
+
+    // Dirty regions of the image are clipped to it and shifted by the padding
+    CvRect rect = sourcePlane.getdirtyrect(cvRect(1, 0, 2, 2));
+    CHECK_MESSAGE(rect.x, 3);
+    CHECK_MESSAGE(rect.y, 2);
+    CHECK_MESSAGE(rect.width, 2);
+    CHECK_MESSAGE(rect.height, 2);
+    rect = sourcePlane.getdirtyrect(cvRect(3, 3, 5, 5));
+    CHECK_MESSAGE(rect.x, 5);
+    CHECK_MESSAGE(rect.y, 5);
+    CHECK_MESSAGE(rect.width, 1);
+    CHECK_MESSAGE(rect.height, 1);
+    rect = sourcePlane.getdirtyrect(cvRect(4, 0, 2, 2));
+    CHECK_MESSAGE(rect.width, 0);
+    CHECK_MESSAGE(rect.height, 0);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvsourceplane_region_test )
+{
+    // 8x8 plane taking 6x6 images padded by 1 pixel
+    CvSourcePlane sourcePlane("test_source_plane", cvSize(8, 8));
+    double mean = 100.0;
+    double scale = 1.0 / 255.0;
+    CHECK_MESSAGE(sourcePlane.setpreprocessing(1, mean, scale, "any"), 1);
+
+    // Colour frames of 9x7 pixels, the alpha channel must be ignored
+    int channels[] = { 3, 4 };
+    int codes[] = { CV_BGR2GRAY, CV_BGRA2GRAY };
+    CvRect rois[] = { cvRect(2, 1, 5, 4), cvRect(0, 0, 9, 7), cvRect(8, 3, 1, 4) };
+    int interps[] = { CV_INTER_NN, CV_INTER_LINEAR };
+    for (int c = 0; c < 2; c++)
+    {
+        CvMat* frame = cvCreateMat(7, 9, channels[c] == 3 ? CV_32FC3 : CV_32FC4);
+        for (int y = 0; y < 7; y++)
+        {
+            float* row = (float*) (frame->data.ptr + frame->step * y);
+            for (int k = 0; k < 9 * channels[c]; k++)
+            {
+                row[k] = (float) (127.5 + 127.5 * sin(1.7 * (y * 36 + k)));
+            }
+        }
+
+        // Reference: whole frame to grey, then the region scaled to the input
+        CvMat* grey = cvCreateMat(7, 9, CV_32FC1);
+        cvCvtColor(frame, grey, codes[c]);
+        CvMat* resized = cvCreateMat(6, 6, CV_32FC1);
+        for (int r = 0; r < 3; r++)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                CvMat region;
+                cvGetSubRect(grey, &region, rois[r]);
+                cvResize(&region, resized, interps[i]);
+                CHECK_MESSAGE(sourcePlane.setfmap(frame, rois[r], interps[i]), 1);
+
+                const CvMat* fmap = sourcePlane.getfmap();
+                for (int y = 0; y < 8; y++)
+                {
+                    for (int x = 0; x < 8; x++)
+                    {
+                        double expected = -mean * scale;
+                        if (x >= 1 && x < 7 && y >= 1 && y < 7)
+                        {
+                            expected = (cvmGet(resized, y - 1, x - 1) - mean) * scale;
+                        }
+                        BOOST_CHECK_SMALL(cvmGet(fmap, y, x) - expected, 1e-5);
+                    }
+                }
+            }
+        }
+        cvReleaseMat(&resized);
+        cvReleaseMat(&grey);
+        cvReleaseMat(&frame);
+    }
+
+    // Regions outside the frame and unknown interpolations are rejected
+    CvMat* frame = cvCreateMat(7, 9, CV_32FC3);
+    CHECK_MESSAGE(sourcePlane.setfmap(frame, cvRect(5, 0, 5, 4), CV_INTER_LINEAR), 0);
+    CHECK_MESSAGE(sourcePlane.setfmap(frame, cvRect(0, 0, 5, 4), CV_INTER_AREA), 0);
+    cvReleaseMat(&frame);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvbackend_test )
+{
+    double sourceValues[64];
+    for (int i = 0; i < 64; i++)
+    {
+        sourceValues[i] = ((i * 7) % 11) / 11.0 - 0.5;
+    }
+    CvMat source = cvMat(8, 8, CV_64FC1, sourceValues);
+
+    double weightValues[16];
+    for (int i = 0; i < 16; i++)
+    {
+        weightValues[i] = ((i * 5) % 7) / 7.0 - 0.4;
+    }
+
+    const char* backendNames[] = { "simd", "opencv" };
+    CvBackend* reference = cvGetBackend("reference");
+    BOOST_REQUIRE(reference != 0);
+
+    for (int b = 0; b < 2; b++)
+    {
+        CvBackend* backend = cvGetBackend(backendNames[b]);
+        BOOST_REQUIRE(backend != 0);
+
+        // Specialized (3x3) and generic (4x4) windows, with activation
+        for (int n = 3; n <= 4; n++)
+        {
+            CvMat* expected = cvCreateMat(9 - n, 9 - n, CV_64FC1);
+            CvMat* result = cvCreateMat(9 - n, 9 - n, CV_64FC1);
+            cvSet(expected, cvRealScalar(0.1));
+            cvSet(result, cvRealScalar(0.1));
+            reference->convolve(&source, weightValues, cvSize(n, n), expected);
+            backend->convolve(&source, weightValues, cvSize(n, n), result);
+            reference->activate(expected, CVCONVNET_ACT_TANH, 0.5, 0.2);
+            backend->activate(result, CVCONVNET_ACT_TANH, 0.5, 0.2);
+            for (int y = 0; y < 9 - n; y++)
+            {
+                for (int x = 0; x < 9 - n; x++)
+                {
+                    BOOST_CHECK_CLOSE(cvmGet(result, y, x),
+                                      cvmGet(expected, y, x),
+                                      1e-9);
+                }
+            }
+            cvReleaseMat(&expected);
+            cvReleaseMat(&result);
+        } // for n
+
+        // Strided convolution with specialized (3x3) and generic (4x4) windows
+        for (int n = 3; n <= 4; n++)
+        {
+            int outsz = (8 - n) / 2 + 1;
+            CvMat* expected = cvCreateMat(outsz, outsz, CV_64FC1);
+            CvMat* result = cvCreateMat(outsz, outsz, CV_64FC1);
+            cvSet(expected, cvRealScalar(0.1));
+            cvSet(result, cvRealScalar(0.1));
+            reference->convolvestrided(&source, weightValues, cvSize(n, n), cvSize(2, 2), expected);
+            backend->convolvestrided(&source, weightValues, cvSize(n, n), cvSize(2, 2), result);
+            for (int y = 0; y < outsz; y++)
+            {
+                for (int x = 0; x < outsz; x++)
+                {
+                    BOOST_CHECK_CLOSE(cvmGet(result, y, x),
+                                      cvmGet(expected, y, x),
+                                      1e-9);
+                }
+            }
+            cvReleaseMat(&expected);
+            cvReleaseMat(&result);
+        } // for n
+
+        // Pruned 3x3 window (every third weight kept) against dense convolution
+        double prunedValues[9];
+        int tapValues[9];
+        double tapWeights[9];
+        int ntaps = 0;
+        for (int t = 0; t < 9; t++)
+        {
+            prunedValues[t] = (t % 3 == 1) ? weightValues[t] : 0.0;
+            if (prunedValues[t] != 0.0)
+            {
+                tapValues[ntaps] = t;
+                tapWeights[ntaps++] = prunedValues[t];
+            }
+        }
+        for (int s = 1; s <= 2; s++)
+        {
+            int outsz = (8 - 3) / s + 1;
+            CvMat* expected = cvCreateMat(outsz, outsz, CV_64FC1);
+            CvMat* result = cvCreateMat(outsz, outsz, CV_64FC1);
+            cvSet(expected, cvRealScalar(0.1));
+            cvSet(result, cvRealScalar(0.1));
+            reference->convolvestrided(&source, prunedValues, cvSize(3, 3), cvSize(s, s), expected);
+            backend->convolvesparse(&source, tapValues, tapWeights, ntaps, cvSize(3, 3), cvSize(s, s), result);
+            for (int y = 0; y < outsz; y++)
+            {
+                for (int x = 0; x < outsz; x++)
+                {
+                    BOOST_CHECK_SMALL(cvmGet(result, y, x)
+                                      - cvmGet(expected, y, x), 1e-9);
+                }
+            }
+            cvReleaseMat(&expected);
+            cvReleaseMat(&result);
+        } // for s
+        CvMat sourceRow = cvMat(1, 9, CV_64FC1, sourceValues);
+        BOOST_CHECK_SMALL(backend->dotsparse(&sourceRow, tapValues, tapWeights, ntaps)
+                          - reference->dense(&sourceRow, prunedValues, cvSize(9, 1)), 1e-9);
+
+        // Bank of nine planes (full and partial blocks) with stride 1 and 2
+        for (int s = 1; s <= 2; s++)
+        {
+            int outsz = (8 - 3) / s + 1;
+            const double* bankWeights[9];
+            CvMat* expectedBank[9];
+            CvMat* resultBank[9];
+            for (int p = 0; p < 9; p++)
+            {
+                bankWeights[p] = weightValues + p % 7;
+                expectedBank[p] = cvCreateMat(outsz, outsz, CV_64FC1);
+                resultBank[p] = cvCreateMat(outsz, outsz, CV_64FC1);
+                cvSet(expectedBank[p], cvRealScalar(0.1));
+                cvSet(resultBank[p], cvRealScalar(0.1));
+            }
+            reference->convolvebank(&source, bankWeights, 9, cvSize(3, 3), cvSize(s, s), expectedBank);
+            backend->convolvebank(&source, bankWeights, 9, cvSize(3, 3), cvSize(s, s), resultBank);
+            for (int p = 0; p < 9; p++)
+            {
+                for (int y = 0; y < outsz; y++)
+                {
+                    for (int x = 0; x < outsz; x++)
+                    {
+                        BOOST_CHECK_SMALL(cvmGet(resultBank[p], y, x)
+                                          - cvmGet(expectedBank[p], y, x), 1e-9);
+                    }
+                }
+                cvReleaseMat(&expectedBank[p]);
+                cvReleaseMat(&resultBank[p]);
+            }
+        } // for s
+
+        // Mostly zero source scattered into nine planes with stride 1 and 2
+        double sparseValues[64];
+        for (int i = 0; i < 64; i++)
+        {
+            sparseValues[i] = (i % 5 == 0) ? sourceValues[i] : 0.0;
+        }
+        CvMat sparseSource = cvMat(8, 8, CV_64FC1, sparseValues);
+        for (int s = 1; s <= 2; s++)
+        {
+            int outsz = (8 - 3) / s + 1;
+            const double* bankWeights[9];
+            CvMat* expectedBank[9];
+            CvMat* resultBank[9];
+            for (int p = 0; p < 9; p++)
+            {
+                bankWeights[p] = weightValues + p % 7;
+                expectedBank[p] = cvCreateMat(outsz, outsz, CV_64FC1);
+                resultBank[p] = cvCreateMat(outsz, outsz, CV_64FC1);
+                cvSet(expectedBank[p], cvRealScalar(0.1));
+                cvSet(resultBank[p], cvRealScalar(0.1));
+            }
+            reference->convolvebank(&sparseSource, bankWeights, 9, cvSize(3, 3), cvSize(s, s), expectedBank);
+            backend->convolvescatter(&sparseSource, bankWeights, 9, cvSize(3, 3), cvSize(s, s), resultBank);
+            for (int p = 0; p < 9; p++)
+            {
+                for (int y = 0; y < outsz; y++)
+                {
+                    for (int x = 0; x < outsz; x++)
+                    {
+                        BOOST_CHECK_SMALL(cvmGet(resultBank[p], y, x)
+                                          - cvmGet(expectedBank[p], y, x), 1e-9);
+                    }
+                }
+                cvReleaseMat(&expectedBank[p]);
+                cvReleaseMat(&resultBank[p]);
+            }
+        } // for s
+
+        // Three channels interleaved, convolved with 3x1 window
+        const CvMat* channels[] = { &source, &source, &source };
+        CvMat* packed = cvCreateMat(8, 24, CV_64FC1);
+        CvMat* packedRef = cvCreateMat(8, 24, CV_64FC1);
+        backend->interleave(channels, 3, packed);
+        reference->interleave(channels, 3, packedRef);
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                CHECK_MESSAGE(cvmGet(packed, y, 3 * x + 2), cvmGet(&source, y, x));
+                CHECK_MESSAGE(cvmGet(packedRef, y, 3 * x), cvmGet(&source, y, x));
+            }
+        }
+        CvMat* expectedPacked = cvCreateMat(8, 6, CV_64FC1);
+        CvMat* resultPacked = cvCreateMat(8, 6, CV_64FC1);
+        cvSet(expectedPacked, cvRealScalar(0.1));
+        cvSet(resultPacked, cvRealScalar(0.1));
+        reference->convolvepacked(packedRef, weightValues, 3, cvSize(3, 1), cvSize(1, 1), expectedPacked);
+        backend->convolvepacked(packed, weightValues, 3, cvSize(3, 1), cvSize(1, 1), resultPacked);
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 6; x++)
+            {
+                BOOST_CHECK_SMALL(cvmGet(resultPacked, y, x)
+                                  - cvmGet(expectedPacked, y, x), 1e-9);
+            }
+        }
+        cvReleaseMat(&packed);
+        cvReleaseMat(&packedRef);
+        cvReleaseMat(&expectedPacked);
+        cvReleaseMat(&resultPacked);
+
+        CvMat* expectedSum = cvCreateMat(4, 4, CV_64FC1);
+        CvMat* resultSum = cvCreateMat(4, 4, CV_64FC1);
+        CvMat* expectedMax = cvCreateMat(4, 4, CV_64FC1);
+        CvMat* resultMax = cvCreateMat(4, 4, CV_64FC1);
+        cvSetZero(expectedSum);
+        cvSetZero(resultSum);
+        cvSet(expectedMax, cvRealScalar(-1.0));
+        cvSet(resultMax, cvRealScalar(-1.0));
+        reference->sumpool(&source, cvSize(2, 2), expectedSum);
+        backend->sumpool(&source, cvSize(2, 2), resultSum);
+        reference->maxpool(&source, cvSize(2, 2), expectedMax);
+        backend->maxpool(&source, cvSize(2, 2), resultMax);
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 4; x++)
+            {
+                BOOST_CHECK_SMALL(cvmGet(resultSum, y, x)
+                                  - cvmGet(expectedSum, y, x), 1e-9);
+                CHECK_MESSAGE(cvmGet(resultMax, y, x),
+                              cvmGet(expectedMax, y, x));
+            }
+        }
+        cvReleaseMat(&expectedSum);
+        cvReleaseMat(&resultSum);
+        cvReleaseMat(&expectedMax);
+        cvReleaseMat(&resultMax);
+
+        BOOST_CHECK_CLOSE(backend->dense(&source, weightValues, cvSize(3, 3)),
+                          reference->dense(&source, weightValues, cvSize(3, 3)),
+                          1e-9);
+        BOOST_CHECK_CLOSE(backend->distance(&source, weightValues, cvSize(3, 3)),
+                          reference->distance(&source, weightValues, cvSize(3, 3)),
+                          1e-9);
+        // Weighted sum of two feature maps
+        const CvMat* combined[] = { &source, &source };
+        CvMat* expectedComb = cvCreateMat(7, 7, CV_64FC1);
+        CvMat* resultComb = cvCreateMat(7, 7, CV_64FC1);
+        cvSet(expectedComb, cvRealScalar(0.1));
+        cvSet(resultComb, cvRealScalar(0.1));
+        reference->combine(combined, weightValues, 2, expectedComb);
+        backend->combine(combined, weightValues, 2, resultComb);
+        for (int y = 0; y < 7; y++)
+        {
+            for (int x = 0; x < 7; x++)
+            {
+                BOOST_CHECK_SMALL(cvmGet(resultComb, y, x)
+                                  - cvmGet(expectedComb, y, x), 1e-9);
+            }
+        }
+        cvReleaseMat(&expectedComb);
+        cvReleaseMat(&resultComb);
+
+        CHECK_MESSAGE(backend->argmax(sourceValues, 64),
+                      reference->argmax(sourceValues, 64));
+    } // for b
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnet_tocode_test )
+{
+    CvConvNet net;
+    BOOST_REQUIRE(net.fromString(createTestNetXml()));
+
+    CvMat* input = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(input, 0);
+    double expected = net.fprop(input);
+
+    std::string code;
+    BOOST_REQUIRE(net.toCode("test_fprop", code));
+
+    // Generated code with a main() printing the result and both outputs
+    std::ofstream source("cvconvnet_tocode_test.cpp");
+    source.precision(17);
+    source << code << std::endl;
+    source << "#include <stdio.h>" << std::endl;
+    source << "static const double input[] = {";
+    for (int i = 0; i < 144; i++)
+    {
+        source << (i ? ", " : " ") << input->data.db[i];
+    }
+    source << " };" << std::endl;
+    source << "int main()" << std::endl;
+    source << "{" << std::endl;
+    source << "    static struct test_fprop_state s;" << std::endl;
+    source << "    double result = test_fprop(&s, input);" << std::endl;
+    source << "    printf(\"%.17g %.17g %.17g\\n\", result, s.p_out0[0][0], s.p_out1[0][0]);" << std::endl;
+    source << "    return 0;" << std::endl;
+    source << "}" << std::endl;
+    source.close();
+
+    int built = system(CVCONVNET_TEST_CXX " -o cvconvnet_tocode_test cvconvnet_tocode_test.cpp -lm");
+    BOOST_REQUIRE_MESSAGE(built == 0, "generated code does not compile");
+
+    double result = -1.0, out0 = 0.0, out1 = 0.0;
+    FILE* output = popen("./cvconvnet_tocode_test", "r");
+    BOOST_REQUIRE(output != 0);
+    int scanned = fscanf(output, "%lf %lf %lf", &result, &out0, &out1);
+    CHECK_MESSAGE(scanned, 3);
+    pclose(output);
+    remove("cvconvnet_tocode_test.cpp");
+    remove("cvconvnet_tocode_test");
+
+    CHECK_MESSAGE(result, expected);
+    BOOST_CHECK_CLOSE(out0, cvmGet(net.getplane("out0"), 0, 0), 1e-9);
+    BOOST_CHECK_CLOSE(out1, cvmGet(net.getplane("out1"), 0, 0), 1e-9);
+
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnet_eval_test )
+{
+    CvConvNet net;
+    CvConvNet reference;
+    BOOST_REQUIRE(net.fromString(createTestNetXml()));
+    BOOST_REQUIRE(reference.fromString(createTestNetXml()));
+    CHECK_MESSAGE(net.getinputsz().width, 12);
+    CHECK_MESSAGE(net.getinputsz().height, 12);
+    CvConvNet empty;
+    CHECK_MESSAGE(empty.getinputsz().width, 0);
+    double mean = -1.0;
+    double scale = -1.0;
+    CHECK_MESSAGE(net.getnormalization(mean, scale), 1);
+    CHECK_MESSAGE(mean, 0.0);
+    CHECK_MESSAGE(scale, 1.0);
+
+    CvMat* input = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(input, 1);
+    reference.fprop(input);
+
+    // Feature maps of the previous input, read directly since getplane()
+    // would compute them
+    CvMat* previous = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(previous, 0);
+    net.fprop(previous);
+    const CvMat* s2_0 = net.getplane("s2_0");
+    const CvMat* c3_0 = net.getplane("c3_0");
+    double s2_0previous = cvmGet(s2_0, 0, 0);
+    double c3_0previous = cvmGet(c3_0, 0, 0);
+
+    // Only the ancestors of a mid-graph plane are computed
+    CHECK_MESSAGE(net.setinput(input), 1);
+    const CvMat* s2 = net.eval("s2_1");
+    BOOST_REQUIRE(s2 != 0);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            CHECK_MESSAGE(cvmGet(s2, y, x), cvmGet(reference.getplane("s2_1"), y, x));
+        }
+    }
+    CHECK_MESSAGE(cvmGet(s2_0, 0, 0), s2_0previous);
+    CHECK_MESSAGE(cvmGet(c3_0, 0, 0), c3_0previous);
+    BOOST_CHECK(s2_0previous != cvmGet(reference.getplane("s2_0"), 0, 0));
+
+    // Planes already computed are reused by the rest of the network
+    std::vector<std::string> outputs;
+    outputs.push_back("out0");
+    outputs.push_back("out1");
+    CHECK_MESSAGE(net.eval(outputs), 1);
+    CHECK_MESSAGE(cvmGet(net.getplane("out0"), 0, 0), cvmGet(reference.getplane("out0"), 0, 0));
+    CHECK_MESSAGE(cvmGet(net.getplane("out1"), 0, 0), cvmGet(reference.getplane("out1"), 0, 0));
+
+    BOOST_CHECK(net.eval("no_such_plane") == 0);
+
+    cvReleaseMat(&input);
+    cvReleaseMat(&previous);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnet_exit_test )
+{
+    CvConvNet reference;
+    BOOST_REQUIRE(reference.fromString(createTestNetXml()));
+
+    CvMat* input = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(input, 2);
+    double expected = reference.fprop(input);
+    CHECK_MESSAGE(reference.getexit(), "res");
+
+    // Confidence of out0 is above the threshold, the network stops there
+    CvConvNet confident;
+    BOOST_REQUIRE(confident.fromString(createTestNetXml(
+        "<exit plane=\"out0\" threshold=\"0\"/>\n")));
+    double result = confident.fprop(input);
+    CHECK_MESSAGE(confident.getexit(), "out0");
+    CHECK_MESSAGE(result, cvmGet(reference.getplane("out0"), 0, 0));
+
+    // Planes skipped by the exit are computed on request
+    CHECK_MESSAGE(cvmGet(confident.getplane("out1"), 0, 0), 
+                  cvmGet(reference.getplane("out1"), 0, 0));
+    CHECK_MESSAGE(confident.getexit(), "out0");
+
+    // Confidence below the threshold, the whole network is propagated
+    CvConvNet unsure;
+    BOOST_REQUIRE(unsure.fromString(createTestNetXml(
+        "<exit plane=\"out0\" threshold=\"1000\"/>\n")));
+    result = unsure.fprop(input);
+    CHECK_MESSAGE(unsure.getexit(), "res");
+    CHECK_MESSAGE(result, expected);
+
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnet_sharebanks_test )
+{
+    // C3 connection table of LeNet-5, S2 planes read by every C3 plane
+    int table[16][6] = {
+        { 1, 1, 1, 0, 0, 0 }, { 0, 1, 1, 1, 0, 0 }, { 0, 0, 1, 1, 1, 0 },
+        { 0, 0, 0, 1, 1, 1 }, { 1, 0, 0, 0, 1, 1 }, { 1, 1, 0, 0, 0, 1 },
+        { 1, 1, 1, 1, 0, 0 }, { 0, 1, 1, 1, 1, 0 }, { 0, 0, 1, 1, 1, 1 },
+        { 1, 0, 0, 1, 1, 1 }, { 1, 1, 0, 0, 1, 1 }, { 1, 1, 1, 0, 0, 1 },
+        { 1, 1, 0, 1, 1, 0 }, { 0, 1, 1, 0, 1, 1 }, { 1, 0, 1, 1, 0, 1 },
+        { 1, 1, 1, 1, 1, 1 } };
+
+    std::ostringstream xml;
+    int seed = 0;
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+    xml << "<net name=\"lenet\" creator=\"test\">" << std::endl;
+    xml << "<info> test </info>" << std::endl;
+    xml << "<plane id=\"src\" type=\"source\" featuremapsize=\"14x14\"></plane>" << std::endl;
+    for (int i = 0; i < 6; i++)
+    {
+        std::ostringstream c1, s2;
+        c1 << "c1_" << i;
+        s2 << "s2_" << i;
+        appendTestPlane(xml, seed, c1.str(), "convolution", "10x10", "5x5",
+                        std::vector<std::string>(1, "src"), 25);
+        appendTestPlane(xml, seed, s2.str(), "subsampling", "5x5", "2x2",
+                        std::vector<std::string>(1, c1.str()), 1);
+    }
+    // Weights as written to the XML by appendTestPlane()
+    auto printed = [](int i) {
+        std::ostringstream weight;
+        weight << testWeight(i);
+        return atof(weight.str().c_str());
+    };
+    std::vector< std::vector<CvGenericPlane *> > c3Parents(16);
+    std::vector< std::vector<double> > c3Weights(16);
+    std::vector<CvSourcePlane *> s2Planes;
+    for (int i = 0; i < 6; i++)
+    {
+        std::ostringstream s2;
+        s2 << "s2_" << i;
+        s2Planes.push_back(new CvSourcePlane(s2.str(), cvSize(5, 5)));
+    }
+    for (int j = 0; j < 16; j++)
+    {
+        std::ostringstream c3;
+        c3 << "c3_" << j;
+        std::vector<std::string> parents;
+        c3Weights[j].push_back(printed(seed));
+        for (int i = 0; i < 6; i++)
+        {
+            if (table[j][i])
+            {
+                parents.push_back(s2Planes[i]->getid());
+                c3Parents[j].push_back(s2Planes[i]);
+                for (int w = 0; w < 9; w++)
+                {
+                    c3Weights[j].push_back(printed(seed + 1 + (c3Parents[j].size() - 1) * 9 + w));
+                }
+            }
+        }
+        appendTestPlane(xml, seed, c3.str(), "convolution", "3x3", "3x3",
+                        parents, 9);
+    }
+    xml << "<plane id=\"out\" type=\"regression\" featuremapsize=\"1x1\" neuronsize=\"1x1\">"
+        << "<bias> 0 </bias><connection to=\"c3_0\"> 1 </connection></plane>" << std::endl;
+    xml << "</net>" << std::endl;
+
+    CvConvNet net;
+    BOOST_REQUIRE(net.fromString(xml.str()));
+    CvMat* input = cvCreateMat(14, 14, CV_64FC1);
+    for (int y = 0; y < 14; y++)
+    {
+        for (int x = 0; x < 14; x++)
+        {
+            cvmSet(input, y, x, testWeight(y * 14 + x));
+        }
+    }
+    net.fprop(input);
+
+    // Every C3 plane computed on its own from the same S2 maps
+    for (int i = 0; i < 6; i++)
+    {
+        CvMat* s2 = cvCloneMat(net.getplane(s2Planes[i]->getid()));
+        CHECK_MESSAGE(s2Planes[i]->setfmap(s2), 1);
+        cvReleaseMat(&s2);
+    }
+    for (int j = 0; j < 16; j++)
+    {
+        std::ostringstream c3;
+        c3 << "c3_" << j;
+        CvConvolutionPlane plane("test_c3", cvSize(3, 3), cvSize(3, 3));
+        CHECK_MESSAGE(plane.connto(c3Parents[j]), 1);
+        CHECK_MESSAGE(plane.setweight(c3Weights[j]), 1);
+        const CvMat* expected = plane.fprop();
+        const CvMat* result = net.getplane(c3.str());
+        for (int y = 0; y < 3; y++)
+        {
+            for (int x = 0; x < 3; x++)
+            {
+                BOOST_CHECK_SMALL(cvmGet(result, y, x)
+                                  - cvmGet(expected, y, x), 1e-12);
+            }
+        }
+    }
+
+    // C3 planes form one bank, evaluating one of them computes all
+    CvConvNet lazy;
+    BOOST_REQUIRE(lazy.fromString(xml.str()));
+    int set = lazy.setinput(input);
+    CHECK_MESSAGE(set, 1);
+    BOOST_REQUIRE(lazy.eval("c3_15") != NULL);
+    CHECK_MESSAGE(cvmGet(lazy.getplane("c3_0"), 1, 1),
+                  cvmGet(net.getplane("c3_0"), 1, 1));
+
+    for (int i = 0; i < 6; i++)
+    {
+        delete s2Planes[i];
+    }
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnet_dirty_test )
+{
+    // Windows of outputs 1 and 2 of a padded strided plane cover pixel 3
+    CvConvolutionPlane stridedPlane("test_strided", cvSize(4, 4), cvSize(3, 3),
+                                    cvSize(2, 2), cvSize(1, 1));
+    CvRect rect = stridedPlane.getdirtyrect(cvRect(3, 3, 1, 1));
+    CHECK_MESSAGE(rect.x, 1);
+    CHECK_MESSAGE(rect.y, 1);
+    CHECK_MESSAGE(rect.width, 2);
+    CHECK_MESSAGE(rect.height, 2);
+    rect = stridedPlane.getdirtyrect(cvRect(0, 0, 1, 1));
+    CHECK_MESSAGE(rect.x, 0);
+    CHECK_MESSAGE(rect.y, 0);
+    CHECK_MESSAGE(rect.width, 1);
+    CHECK_MESSAGE(rect.height, 1);
+
+    // A dense block on a blank source, regions around it are computed
+    // the same way as the whole source (the OpenCV filter and the scatter
+    // differ in the last bits)
+    CvSourcePlane blankPlane("test_blank", cvSize(32, 32));
+    CvMat* blank = cvCreateMat(32, 32, CV_64FC1);
+    cvZero(blank);
+    for (int y = 10; y < 16; y++)
+    {
+        for (int x = 10; x < 16; x++)
+        {
+            cvmSet(blank, y, x, testWeight(y * 32 + x));
+        }
+    }
+    CHECK_MESSAGE(blankPlane.setfmap(blank), 1);
+    std::vector<CvGenericPlane *> parentPlanes(1, &blankPlane);
+    CvConvolutionPlane blockPlane("test_block", cvSize(28, 28), cvSize(5, 5));
+    std::vector<double> weights(26);
+    for (int i = 0; i < 26; i++)
+    {
+        weights[i] = testWeight(i);
+    }
+    CHECK_MESSAGE(blockPlane.connto(parentPlanes), 1);
+    CHECK_MESSAGE(blockPlane.setweight(weights), 1);
+    blockPlane.setbackend(cvGetBackend("opencv"));
+    CvMat* full = cvCloneMat(blockPlane.fprop());
+    CvMat* region = blockPlane.fpropregion(cvRect(8, 8, 4, 4));
+    for (int y = 0; y < 28; y++)
+    {
+        for (int x = 0; x < 28; x++)
+        {
+            CHECK_MESSAGE(cvmGet(region, y, x), cvmGet(full, y, x));
+        }
+    }
+    cvReleaseMat(&full);
+    cvReleaseMat(&blank);
+
+    // Mostly blank images, the changed block is dense on its own
+    CvMat* previous = cvCreateMat(12, 12, CV_64FC1);
+    cvZero(previous);
+    cvmSet(previous, 0, 11, 0.7);
+    cvmSet(previous, 1, 1, -0.4);
+    cvmSet(previous, 10, 2, 0.9);
+    cvmSet(previous, 11, 10, 0.3);
+    CvMat* input = cvCloneMat(previous);
+    for (int y = 5; y < 8; y++)
+    {
+        for (int x = 5; x < 8; x++)
+        {
+            cvmSet(input, y, x, 0.1 * (y - x) + 0.5);
+        }
+    }
+
+    CvConvNet reference;
+    BOOST_REQUIRE(reference.fromString(createTestNetXml()));
+    double expected = reference.fprop(input);
+
+    // Only the changed region is propagated, with exactly the same result
+    CvConvNet incremental;
+    BOOST_REQUIRE(incremental.fromString(createTestNetXml()));
+    incremental.fprop(previous);
+    double result = incremental.fpropincr(input);
+    CHECK_MESSAGE(result, expected);
+
+    CvConvNet dirty;
+    BOOST_REQUIRE(dirty.fromString(createTestNetXml()));
+    dirty.fprop(previous);
+    result = dirty.fprop(input, std::vector<CvRect>(1, cvRect(5, 5, 3, 3)));
+    CHECK_MESSAGE(result, expected);
+
+    const char* ids[] = { "c1_0", "c1_1", "c3_0", "out0", "out1" };
+    for (int i = 0; i < 5; i++)
+    {
+        const CvMat* fmap = reference.getplane(ids[i]);
+        const CvMat* fmap1 = incremental.getplane(ids[i]);
+        const CvMat* fmap2 = dirty.getplane(ids[i]);
+        for (int y = 0; y < fmap->rows; y++)
+        {
+            for (int x = 0; x < fmap->cols; x++)
+            {
+                CHECK_MESSAGE(cvmGet(fmap1, y, x), cvmGet(fmap, y, x));
+                CHECK_MESSAGE(cvmGet(fmap2, y, x), cvmGet(fmap, y, x));
+            }
+        }
+    }
+
+    cvReleaseMat(&previous);
+    cvReleaseMat(&input);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvresultcache_test )
+{
+    CvMat* input = cvCreateMat(12, 12, CV_64FC1);
+    CvMat* other = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(input, 0);
+    fillTestInput(other, 1);
+
+    CvResultCache cache(2);
+    uint64 key = CvResultCache::hash(input);
+    cache.store(key, input, 0.5, 3);
+
+    double value = 0.0;
+    int planeidx = -1;
+    int found = cache.lookup(key, input, value, planeidx);
+    CHECK_MESSAGE(found, 1);
+    CHECK_MESSAGE(value, 0.5);
+    CHECK_MESSAGE(planeidx, 3);
+
+    // Another input under the same key is a collision, not a hit
+    found = cache.lookup(key, other, value, planeidx);
+    CHECK_MESSAGE(found, 0);
+    CHECK_MESSAGE(cache.gethits(), 1);
+    CHECK_MESSAGE(cache.getmisses(), 1);
+
+    // Repeated inputs of a network are served from the cache
+    CvConvNet net;
+    BOOST_REQUIRE(net.fromString(createTestNetXml()));
+    cache.clear();
+    net.setcache(&cache);
+    double expected = net.fprop(input);
+    double result = net.fprop(other);
+    result = net.fprop(input);
+    CHECK_MESSAGE(result, expected);
+    CHECK_MESSAGE(cache.gethits(), 1);
+    CHECK_MESSAGE(cache.getmisses(), 2);
+
+    // Planes of a cached result are computed for that input, not kept
+    // from the previous one
+    CvConvNet uncached;
+    BOOST_REQUIRE(uncached.fromString(createTestNetXml()));
+    uncached.fprop(input);
+    const CvMat* s2 = net.getplane("s2_1");
+    const CvMat* s2expected = uncached.getplane("s2_1");
+    for (int y = 0; y < s2->rows; y++)
+    {
+        for (int x = 0; x < s2->cols; x++)
+        {
+            CHECK_MESSAGE(cvmGet(s2, y, x), cvmGet(s2expected, y, x));
+        }
+    }
+
+    // Results of the network before pruning are dropped
+    int pruned = net.prune(0.1);
+    BOOST_CHECK(pruned > 0);
+    CHECK_MESSAGE(cache.gethits(), 0);
+    CvConvNet reference;
+    BOOST_REQUIRE(reference.fromString(createTestNetXml()));
+    reference.prune(0.1);
+    expected = reference.fprop(input);
+    result = net.fprop(input);
+    CHECK_MESSAGE(result, expected);
+    CHECK_MESSAGE(cache.gethits(), 0);
+
+    cvReleaseMat(&input);
+    cvReleaseMat(&other);
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( cvconvnettuner_test )
+{
+    CvSourcePlane sourcePlane = createTestCvSourcePlane();
+    std::vector<CvGenericPlane *> parentPlanes;
+    parentPlanes.push_back(&sourcePlane);
+
+    // Same shape, the planes differ in padding and in pruned kernels
+    CvConvolutionPlane densePlane("test_dense", cvSize(3, 3), cvSize(3, 3),
+                                  cvSize(2, 2));
+    CvConvolutionPlane paddedPlane("test_padded", cvSize(3, 3), cvSize(3, 3),
+                                   cvSize(2, 2), cvSize(1, 1));
+    CvConvolutionPlane prunedPlane("test_pruned", cvSize(3, 3), cvSize(3, 3),
+                                   cvSize(2, 2));
+    std::vector<double> weights(10);
+    for (int i = 0; i < 10; i++)
+    {
+        weights[i] = testWeight(i);
+    }
+    std::vector<double> pruned(10, 0.0);
+    pruned[5] = 1.0;
+    CHECK_MESSAGE(densePlane.connto(parentPlanes), 1);
+    CHECK_MESSAGE(densePlane.setweight(weights), 1);
+    CHECK_MESSAGE(paddedPlane.connto(parentPlanes), 1);
+    CHECK_MESSAGE(paddedPlane.setweight(weights), 1);
+    CHECK_MESSAGE(prunedPlane.connto(parentPlanes), 1);
+    CHECK_MESSAGE(prunedPlane.setweight(pruned), 1);
+
+    std::vector<CvGenericPlane *> planes;
+    planes.push_back(&sourcePlane);
+    planes.push_back(&densePlane);
+    planes.push_back(&paddedPlane);
+    planes.push_back(&prunedPlane);
+    std::vector<int> leaders;
+    for (int i = 0; i < planes.size(); i++)
+    {
+        leaders.push_back(i);
+    }
+
+    // Every plane gets its own cache line, timed on a nonzero input
+    std::string cachefile = "cvconvnettuner_test.cache";
+    std::remove(cachefile.c_str());
+    int tuned = tune(planes, leaders, cachefile);
+    CHECK_MESSAGE(tuned, 1);
+    CHECK_MESSAGE(cvCountNonZero(sourcePlane.getfmap()), 64);
+
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(cachefile.c_str());
+        std::string line;
+        while (std::getline(in, line))
+        {
+            lines.push_back(line);
+        }
+    }
+    CHECK_MESSAGE(lines.size(), 3);
+
+    // Choices found in the cache are applied without timing
+    {
+        std::ofstream out(cachefile.c_str());
+        for (int i = 0; i < lines.size(); i++)
+        {
+            out << lines[i].substr(0, lines[i].rfind('\t')) << "\treference"
+                << std::endl;
+        }
+    }
+    for (int i = 1; i < planes.size(); i++)
+    {
+        planes[i]->setbackend(cvGetBackend("simd"));
+    }
+    tuned = tune(planes, leaders, cachefile);
+    CHECK_MESSAGE(tuned, 1);
+    for (int i = 1; i < planes.size(); i++)
+    {
+        CHECK_MESSAGE(planes[i]->getbackend()->getname(), "reference");
+    }
+    std::remove(cachefile.c_str());
+
+    // Groups are timed by their leaders only and keyed by their size
+    CvConvNet net;
+    BOOST_REQUIRE(net.fromString(createTestNetXml()));
+    tuned = net.tune(cachefile);
+    CHECK_MESSAGE(tuned, 1);
+    int banks = 0, outputs = 0;
+    {
+        std::ifstream in(cachefile.c_str());
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.find("\tconvolution 8x8 ") != std::string::npos)
+            {
+                banks++;
+                BOOST_CHECK(line.find(" group 2\t") != std::string::npos);
+            }
+            if (line.find("\tregression ") != std::string::npos)
+            {
+                outputs++;
+                BOOST_CHECK(line.find(" group 2\t") != std::string::npos);
+            }
+        }
+    }
+    CHECK_MESSAGE(banks, 1);
+    CHECK_MESSAGE(outputs, 1);
+
+    CvConvNet reference;
+    BOOST_REQUIRE(reference.fromString(createTestNetXml()));
+    CvMat* input = cvCreateMat(12, 12, CV_64FC1);
+    fillTestInput(input, 0);
+    BOOST_CHECK_SMALL(net.fprop(input) - reference.fprop(input), 1e-9);
+    cvReleaseMat(&input);
+    std::remove(cachefile.c_str());
+} // BOOST_AUTO_TEST_CASE
+
+BOOST_AUTO_TEST_CASE( boundedqueue_test )
+{
+    BoundedQueue<int> queue(2);
+    bool pushed = queue.push(1) && queue.push(2);
+    CHECK_MESSAGE(pushed, true);
+
+    // A third push blocks until the consumer pops
+    pushed = false;
+    std::thread producer([&queue, &pushed]() { pushed = queue.push(3); });
+    int item = 0;
+    bool popped = queue.pop(item);
+    CHECK_MESSAGE(popped, true);
+    CHECK_MESSAGE(item, 1);
+    producer.join();
+    CHECK_MESSAGE(pushed, true);
+
+    // Items queued before close() are still delivered in order
+    queue.close();
+    bool refused = !queue.push(4);
+    CHECK_MESSAGE(refused, true);
+    popped = queue.pop(item);
+    CHECK_MESSAGE(popped, true);
+    CHECK_MESSAGE(item, 2);
+    popped = queue.pop(item);
+    CHECK_MESSAGE(popped, true);
+    CHECK_MESSAGE(item, 3);
+    popped = queue.pop(item);
+    CHECK_MESSAGE(popped, false);
+
+    // A consumer waiting on an empty queue is released by close()
+    BoundedQueue<int> empty(1);
+    bool released = true;
+    std::thread consumer([&empty, &released, &item]() { released = !empty.pop(item); });
+    empty.close();
+    consumer.join();
+    CHECK_MESSAGE(released, true);
+} // BOOST_AUTO_TEST_CASE
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+/*!\file
+ * \brief Ahead-of-time compiler of convolutional networks
+ * \date 2026
+ */
+
+#include "cvconvnet.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+/*! The program loads a network from its XML description
+ * and writes a self-contained C++ source file with the
+ * forward propagation of that network.
+ * Usage of the program is the following:
+ * $ ./cvconvnet-compile [net.xml] [output.cpp] [function]
+ * 
+ * net.xml is XML description of the network
+ * output.cpp is the generated source file
+ * function is the name of generated function (convnet_fprop by default)
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= 2)
+	{
+		cerr << "Usage: " << endl << "\tcvconvnet-compile <network.xml> <output.cpp> [function]" << endl;
+		return 1;
+	}
+
+	string funcname = (argc > 3) ? argv[3] : "convnet_fprop";
+
+	// Create empty net object
+	CvConvNet net;
+
+	// Load XML file into a std::string called xml
+	ifstream ifs(argv[1]);
+	string xml ( (istreambuf_iterator<char> (ifs)) , istreambuf_iterator<char>() );
+
+	// Create network from XML string
+	if ( !net.fromString(xml) )
+	{
+		cerr << "*** ERROR: Can't load net from XML" << endl << "Check file "<< argv[1] << endl;
+		return 1;
+	}
+
+	// Generate the code
+	string code;
+	if ( !net.toCode(funcname, code) )
+	{
+		cerr << "*** ERROR: Can't generate code for network " << argv[1] << endl;
+		return 1;
+	}
+
+	ofstream ofs(argv[2]);
+	ofs << code;
+	if ( !ofs )
+	{
+		cerr << "*** ERROR: Can't write file " << argv[2] << endl;
+		return 1;
+	}
+
+	return 0;
+}
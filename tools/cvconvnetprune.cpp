@@ -0,0 +1,185 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+
+/*!\file
+ * \brief Magnitude pruning of convolutional networks
+ * \date 2026
+ */
+
+#include "cvconvnet.h"
+#include "cvidx.h"
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+/*!
+ * \param images images, one per row
+ * \param dims dimensions of the images file
+ * \param i index of the image
+ * \return header of the image
+ */
+static CvMat icvImage(CvMat *images, const vector<int> &dims, int i)
+{
+	return cvMat(dims[1], dims[2], CV_8UC1, images->data.ptr + (size_t)images->step*i);
+}
+
+/*! The function runs the network over a labelled IDX set, the output of 
+ * the network is taken as the predicted label (as in testmnist).
+ * Images are fed as they are, padding and normalization are done 
+ * by the source plane of the network.
+ * \param net the network
+ * \param images images, one per row
+ * \param dims dimensions of the images file
+ * \param labels labels, one per row
+ * \return fraction of correctly classified images
+ */
+static double icvAccuracy(CvConvNet &net, CvMat *images, const vector<int> &dims, CvMat *labels)
+{
+	int correct = 0;
+	for (int i=0; i<images->rows; i++)
+	{
+		CvMat img = icvImage(images, dims, i);
+		int pos = (int) net.fprop(&img);
+		if (pos == labels->data.ptr[(size_t)labels->step*i])
+			correct++;
+	}
+
+	return (double) correct/images->rows;
+}
+
+/*! The program loads a network from its XML description, sets its weights
+ * of magnitude below the threshold to zero and writes the pruned network.
+ * With a tolerance, convolution kernels are also replaced by their low rank
+ * approximations (see CvConvNet::approximate()).
+ * When an IDX validation set is given, accuracy of the network before and
+ * after pruning is reported.
+ * Usage of the program is the following:
+ * $ ./cvconvnet-prune [net.xml] [threshold] [pruned.xml] [images.idx] [labels.idx] [tolerance]
+ * 
+ * net.xml is XML description of the network
+ * threshold is magnitude of the smallest weight to keep
+ * pruned.xml is the pruned network
+ * images.idx and labels.idx are the validation set (for instance t10k-images-idx3-ubyte
+ * and t10k-labels-idx1-ubyte of MNIST), the images must be of the input size
+ * of the network's source plane (28x28 MNIST images for a 32x32 source 
+ * plane with padding="2")
+ * tolerance is relative error of an approximated kernel in Frobenius norm (0 for none)
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= 3 || argc == 5)
+	{
+		cerr << "Usage: " << endl << "\tcvconvnet-prune <network.xml> <threshold> <pruned.xml> [<images.idx> <labels.idx> [tolerance]]" << endl;
+		return 1;
+	}
+
+	double threshold = atof(argv[2]);
+	double tolerance = (argc > 6) ? atof(argv[6]) : 0.0;
+
+	// Create empty net object
+	CvConvNet net;
+
+	// Load XML file into a std::string called xml
+	ifstream ifs(argv[1]);
+	string xml ( (istreambuf_iterator<char> (ifs)) , istreambuf_iterator<char>() );
+
+	// Create network from XML string
+	if ( !net.fromString(xml) )
+	{
+		cerr << "*** ERROR: Can't load net from XML" << endl << "Check file "<< argv[1] << endl;
+		return 1;
+	}
+
+	// Validation set
+	CvMat *images = NULL, *labels = NULL;
+	vector<int> dims, ldims;
+	if (argc > 5)
+	{
+		images = cvLoadIDX(argv[4], &dims);
+		labels = cvLoadIDX(argv[5], &ldims);
+
+		if (images == NULL || labels == NULL || dims.size() != 3 || ldims.size() != 1 
+			|| CV_MAT_TYPE(images->type) != CV_8UC1 || CV_MAT_TYPE(labels->type) != CV_8UC1 
+			|| images->rows != labels->rows)
+		{
+			cerr << "*** ERROR: Can't use " << argv[4] << " and " << argv[5] << " as validation set" << endl;
+			return 1;
+		}
+
+		CvMat img = icvImage(images, dims, 0);
+		if (images->rows == 0 || !net.setinput(&img))
+		{
+			cerr << "*** ERROR: Images of " << argv[4] << " don't fit the input of the network" << endl;
+			return 1;
+		}
+	}
+
+	double before = 0.0;
+	if (images)
+		before = icvAccuracy(net, images, dims, labels);
+
+	int pruned = net.prune(threshold);
+	cout << "Pruned weights: " << pruned << endl;
+
+	if (tolerance > 0.0)
+	{
+		int replaced = net.approximate(tolerance);
+		cout << "Approximated kernels: " << replaced << endl;
+	}
+
+	if (images)
+	{
+		double after = icvAccuracy(net, images, dims, labels);
+		cout << "Accuracy before: " << 100.0*before << "%" << endl;
+		cout << "Accuracy after: " << 100.0*after << "%" << endl;
+		cout << "Accuracy delta: " << 100.0*(after-before) << "%" << endl;
+
+		cvReleaseMat(&images);
+		cvReleaseMat(&labels);
+	}
+
+	ofstream ofs(argv[3]);
+	ofs << net.toString();
+	if ( !ofs )
+	{
+		cerr << "*** ERROR: Can't write file " << argv[3] << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+/*****************************************************************************
+ IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING. By
+downloading, copying, installing or using the software you agree to this
+license. If you do not agree to this license, do not download, install, copy or
+use the software.
+
+Contributors License Agreement
+
+Copyright© 2007, Akhmed Umyarov. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+- Redistributions of source code must retain the above copyright notice, this
+list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+- The name of Contributor may not be used to endorse or promote products derived
+from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+All information provided related to future Intel products and plans is
+preliminary and subject to change at any time, without notice.
+*****************************************************************************/
+
+
+/*!\file
+ * \brief Structured pruning of convolutional networks
+ * \date 2026
+ */
+
+#include "cvconvnet.h"
+#include "cvidx.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+//! Results of the network over the validation set
+struct CvShrinkResult
+{
+	vector<double> output; //!< fprop result of every image
+	double accuracy; //!< Fraction of images classified correctly
+	double latency; //!< Mean time of fprop in microseconds
+};
+
+/*! The function runs the network over the validation set, the result
+ * of the network is taken as the predicted label (as in testmnist).
+ * \param net the network
+ * \param images input images
+ * \param labels labels of the images
+ * \return results of the network
+ */
+static CvShrinkResult icvEvaluate(CvConvNet &net, const vector<CvMat *> &images, const vector<int> &labels)
+{
+	CvShrinkResult res;
+	int correct = 0;
+
+	int64 start = cvGetTickCount();
+	for (int i=0; i<images.size(); i++)
+	{
+		double out = net.fprop(images[i]);
+		res.output.push_back(out);
+		if ((int) out == labels[i])
+			correct++;
+	}
+	int64 ticks = cvGetTickCount() - start;
+
+	res.accuracy = (double) correct/images.size();
+	res.latency = ticks/cvGetTickFrequency()/images.size();
+	return res;
+}
+
+/*! The program scores every plane of the network by ablation: the plane
+ * is removed (which is the same as zeroing its feature map for its 
+ * children) and the score is the fraction of validation images whose
+ * result changes. Planes of the lowest scores are removed until the 
+ * requested number of planes is gone, planes left without parents are
+ * removed with them. The smaller network is written as XML.
+ * Usage of the program is the following:
+ * $ ./cvconvnet-shrink [net.xml] [images.idx] [labels.idx] [planes] [shrunk.xml]
+ * 
+ * net.xml is XML description of the network
+ * images.idx and labels.idx are the validation set (for instance t10k-images-idx3-ubyte
+ * and t10k-labels-idx1-ubyte of MNIST), the images must be of the input size
+ * of the network's source plane (28x28 MNIST images for a 32x32 source 
+ * plane with padding="2")
+ * planes is number of planes to remove
+ * shrunk.xml is the smaller network
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= 5)
+	{
+		cerr << "Usage: " << endl << "\tcvconvnet-shrink <network.xml> <images.idx> <labels.idx> <planes> <shrunk.xml>" << endl;
+		return 1;
+	}
+
+	int target = atoi(argv[4]);
+
+	// Load XML file into a std::string called xml
+	ifstream ifs(argv[1]);
+	string xml ( (istreambuf_iterator<char> (ifs)) , istreambuf_iterator<char>() );
+
+	// Create network from XML string
+	CvConvNet net;
+	if ( !net.fromString(xml) )
+	{
+		cerr << "*** ERROR: Can't load net from XML" << endl << "Check file "<< argv[1] << endl;
+		return 1;
+	}
+
+	// Validation set
+	vector<int> dims, ldims;
+	CvMat *idximages = cvLoadIDX(argv[2], &dims);
+	CvMat *idxlabels = cvLoadIDX(argv[3], &ldims);
+	if (idximages == NULL || idxlabels == NULL || dims.size() != 3 || ldims.size() != 1 
+		|| CV_MAT_TYPE(idximages->type) != CV_8UC1 || CV_MAT_TYPE(idxlabels->type) != CV_8UC1 
+		|| idximages->rows != idxlabels->rows || idximages->rows == 0)
+	{
+		cerr << "*** ERROR: Can't use " << argv[2] << " and " << argv[3] << " as validation set" << endl;
+		return 1;
+	}
+
+	// Images are fed as they are, padding and normalization are done 
+	// by the source plane of the network
+	vector<CvMat> headers(idximages->rows);
+	vector<CvMat *> images;
+	vector<int> labels;
+	for (int i=0; i<idximages->rows; i++)
+	{
+		headers[i] = cvMat(dims[1], dims[2], CV_8UC1, idximages->data.ptr + (size_t)idximages->step*i);
+		images.push_back(&headers[i]);
+		labels.push_back(idxlabels->data.ptr[(size_t)idxlabels->step*i]);
+	}
+	cvReleaseMat(&idxlabels);
+
+	if ( !net.setinput(images[0]) )
+	{
+		cerr << "*** ERROR: Images of " << argv[2] << " don't fit the input of the network" << endl;
+		cvReleaseMat(&idximages);
+		return 1;
+	}
+
+	// Sizes are compared at the precision the network is written with
+	xml = net.toString();
+	vector<string> ids = net.getids();
+
+	// The first pass warms up caches
+	icvEvaluate(net, images, labels);
+	CvShrinkResult before = icvEvaluate(net, images, labels);
+
+	// Ablation scores of the planes that can be removed
+	vector< pair<double,string> > score;
+	for (int i=1; i<ids.size()-1; i++)
+	{
+		CvConvNet trial;
+		trial.fromString(xml);
+		if (!trial.removeplane(ids[i]))
+			continue;
+
+		CvShrinkResult res = icvEvaluate(trial, images, labels);
+		int changed = 0;
+		for (int j=0; j<images.size(); j++)
+			changed += (res.output[j] != before.output[j]);
+
+		score.push_back(make_pair((double) changed/images.size(), ids[i]));
+	}
+	stable_sort(score.begin(), score.end());
+
+	int removed = 0;
+	for (int i=0; i<score.size() && removed < target; i++)
+	{
+		// The plane may be gone with a plane removed earlier
+		int n = net.removeplane(score[i].second);
+		if (n > 0)
+		{
+			cout << "Removed " << score[i].second << " (score " << score[i].first << ", " << n << " planes)" << endl;
+			removed += n;
+		}
+	}
+
+	CvShrinkResult after = icvEvaluate(net, images, labels);
+	string shrunk = net.toString();
+
+	cout << "Planes: " << ids.size() << " -> " << net.getids().size() << endl;
+	cout << "XML size: " << xml.size() << " -> " << shrunk.size() << " bytes" << endl;
+	cout << "Accuracy: " << 100.0*before.accuracy << "% -> " << 100.0*after.accuracy << "%" << endl;
+	cout << "Latency: " << before.latency << " -> " << after.latency << " us per image" << endl;
+
+	cvReleaseMat(&idximages);
+
+	ofstream ofs(argv[5]);
+	ofs << shrunk;
+	if ( !ofs )
+	{
+		cerr << "*** ERROR: Can't write file " << argv[5] << endl;
+		return 1;
+	}
+
+	return 0;
+}